@@ -0,0 +1,146 @@
+/****************************************************************************
+ *
+ * libFuzzer target for server's parsers and decoders, aborting if any reads
+ * or writes beyond its input or output or returns what it mustn't
+ * Usage: fuzz [-max_total_time=seconds] [corpus/]
+ *
+ ***************************************************************************/
+
+// server's functions, without its main
+#define HARNESS
+#include "server.c"
+
+// prototypes
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+void fuzzdecoders(const char* s, size_t n);
+void fuzzrequest(const char* s, size_t n);
+
+/**
+ * Feeds input to each of server's parsers and decoders in turn.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    fuzzrequest((const char*) data, size);
+    fuzzdecoders((const char*) data, size);
+    return 0;
+}
+
+/**
+ * Decodes (and escapes) n bytes of s, ensuring each result fits its output
+ * and decoding in place agrees with decoding into a copy, and parses them
+ * as a traceparent header, ensuring IDs are hex.
+ */
+void fuzzdecoders(const char* s, size_t n)
+{
+    // output may be up to 6 times as long as input (if every byte is escaped)
+    char* t = malloc(n * strlen("&quot;") + 1);
+    char* u = malloc(n + 1);
+    if (t == NULL || u == NULL)
+    {
+        free(t);
+        free(u);
+        return;
+    }
+
+    // URL-decode into a copy, then in place
+    size_t decoded = urldecode(s, n, t);
+    memcpy(u, s, n);
+    if (decoded > n || urldecode(u, n, u) != decoded || memcmp(t, u, decoded + 1) != 0)
+    {
+        abort();
+    }
+    traverses(t, decoded);
+
+    // escape for HTML, leaving no special characters unescaped
+    size_t escaped = htmlspecialchars(s, n, t);
+    if (escaped > n * strlen("&quot;") || t[escaped] != '\0' || scan(t, escaped, "\"'<>") != NULL)
+    {
+        abort();
+    }
+
+    // decode as Huffman-encoded, into an output that may prove too short
+    long length = huffman((const unsigned char*) s, n, u, n);
+    if (length > (long) n)
+    {
+        abort();
+    }
+
+    // identify span, with or without a parent
+    struct note note;
+    identify(&note, s, n);
+    if (strspn(note.trace, "0123456789abcdef") != 32 || strspn(note.span, "0123456789abcdef") != 16
+        || strspn(note.parent, "0123456789abcdef") != strlen(note.parent))
+    {
+        abort();
+    }
+    free(t);
+    free(u);
+}
+
+/**
+ * Parses n bytes of s (as though read from a socket, in which case request
+ * would otherwise wait for more) as a request's headers, then its request-line,
+ * ensuring every slice parsed lies within headers, then its Range header,
+ * ensuring every range lies within representation.
+ */
+void fuzzrequest(const char* s, size_t n)
+{
+    // copy input into a buffer just as long, so that reads beyond it are caught
+    n = (n < BUFFER) ? n : BUFFER;
+    struct connection c;
+    memset(&c, 0, sizeof(c));
+    c.fd = -1;
+    c.message = malloc((n > 0) ? n : 1);
+    if (c.message == NULL)
+    {
+        return;
+    }
+    memcpy(c.message, s, n);
+    c.length = n;
+
+    // parse headers, ensuring they (and their slices) lie within buffer
+    struct headers* h = &c.parsed;
+    if (request(&c) && h->invalid == 0)
+    {
+        if (h->end > n || h->fields > LimitRequestFields
+            || h->request.start + h->request.length > h->end || h->request.length + 2 > LimitRequestLine)
+        {
+            abort();
+        }
+        for (int i = 0; i < h->fields; i++)
+        {
+            if (h->names[i].length == 0 || h->names[i].start + h->names[i].length > h->end
+                || h->values[i].start + h->values[i].length > h->end)
+            {
+                abort();
+            }
+        }
+
+        // parse request-line, ensuring path and query are each no longer than it
+        char abs_path[LimitRequestLine + 1];
+        char query[LimitRequestLine + 1];
+        if (parse(&c, abs_path, query)
+            && (strlen(abs_path) > h->request.length || strlen(query) > h->request.length))
+        {
+            abort();
+        }
+        size_t length;
+        header(&c, "Host", &length);
+
+        // parse Range, as though of a representation n bytes long, ensuring every range
+        // lies within it (and is allotted from connection's arena, whence it's reclaimed)
+        client = &c;
+        struct range* ranges = NULL;
+        int parts = partition(n, "\"fuzz\"", 0, &ranges);
+        for (int i = 0; i < parts; i++)
+        {
+            if (ranges[i].first < 0 || ranges[i].first > ranges[i].last || ranges[i].last >= (off_t) n)
+            {
+                abort();
+            }
+        }
+        client = NULL;
+    }
+    reclaim(&c);
+    free(c.message);
+}
@@ -0,0 +1,667 @@
+/****************************************************************************
+ *
+ * Load generator for server, reporting throughput and latency as JSON
+ * Usage: loadgen [-c connections] [-d seconds] [-n name] [-p port] path
+ *
+ ***************************************************************************/
+
+// feature test macro requirements
+#define _GNU_SOURCE
+#define _XOPEN_SOURCE 700
+#define _XOPEN_SOURCE_EXTENDED
+
+// number of bytes for buffers
+#define BYTES 512
+
+// number of readiness events to handle per iteration of event loop
+#define EVENTS 256
+
+// header files
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#endif
+
+// a connection's state
+enum state
+{
+    CONNECTING,
+    SENDING,
+    RECEIVING
+};
+
+// a connection to server, over which requests are sent one at a time
+struct connection
+{
+    // connection's socket and state
+    int fd;
+    enum state state;
+
+    // number of bytes of request already written
+    size_t sent;
+
+    // bytes of response read but not yet parsed, and their length
+    char buffer[BYTES * 32];
+    size_t length;
+
+    // response's status code, whether its headers have been parsed, whether it's
+    // chunked (and, if so, whether its last chunk has been read), bytes of body
+    // (or of current chunk) remaining, and whether server is to close connection
+    int status;
+    bool headed;
+    bool chunked;
+    bool last;
+    long long remaining;
+    bool closing;
+
+    // when request was first written (in microseconds)
+    long long started;
+};
+
+// prototypes
+bool begin(struct connection* c);
+void complete(struct connection* c);
+int compare(const void* a, const void* b);
+bool consume(struct connection* c);
+void fail(struct connection* c);
+bool headers(struct connection* c);
+long long now(void);
+void progress(struct connection* c);
+int ready(void** data, int max, int timeout);
+void reconnect(struct connection* c);
+void report(const char* name, const char* path, int connections, double seconds);
+bool watch(int fd, void* data);
+
+// request to be sent, and its length
+char* request = NULL;
+size_t size = 0;
+
+// server's address
+struct sockaddr_in address;
+
+// latencies of responses (in microseconds) other than refusals (i.e., 503s), whose
+// rate and latencies would otherwise pass for server's, their number and capacity
+unsigned int* latencies = NULL;
+size_t samples = 0;
+size_t capacity = 0;
+
+// bytes received, number of failures, and responses per status code
+unsigned long long received = 0;
+unsigned long errors = 0;
+unsigned long statuses[600];
+
+// number of connections that couldn't reconnect (e.g., for want of descriptors or
+// ports) and are yet to be retried, and fewest connections open at once
+int down = 0;
+int fewest = 0;
+
+// file descriptor for event loop
+int efd = -1;
+
+int main(int argc, char* argv[])
+{
+    // default to 64 connections for 5 seconds to port 8080
+    int connections = 64;
+    double seconds = 5;
+    int port = 8080;
+    const char* name = NULL;
+
+    // usage
+    const char* usage = "Usage: loadgen [-c connections] [-d seconds] [-n name] [-p port] path";
+
+    // parse command-line arguments
+    int opt;
+    while ((opt = getopt(argc, argv, "c:d:hn:p:")) != -1)
+    {
+        switch (opt)
+        {
+            // -c connections
+            case 'c':
+                connections = atoi(optarg);
+                break;
+
+            // -d seconds
+            case 'd':
+                seconds = atof(optarg);
+                break;
+
+            // -h
+            case 'h':
+                printf("%s\n", usage);
+                return 0;
+
+            // -n name
+            case 'n':
+                name = optarg;
+                break;
+
+            // -p port
+            case 'p':
+                port = atoi(optarg);
+                break;
+        }
+    }
+
+    // ensure arguments are sane
+    if (connections < 1 || seconds <= 0 || port < 1 || port > USHRT_MAX
+        || argv[optind] == NULL || argv[optind][0] != '/')
+    {
+        fprintf(stderr, "%s\n", usage);
+        return 2;
+    }
+    const char* path = argv[optind];
+    if (name == NULL)
+    {
+        name = path;
+    }
+
+    // request to be sent again and again
+    const char* template = "GET %s HTTP/1.1\r\nHost: localhost:%i\r\nUser-Agent: loadgen\r\n\r\n";
+    int n = snprintf(NULL, 0, template, path, port);
+    request = malloc(n + 1);
+    if (request == NULL)
+    {
+        return 1;
+    }
+    size = sprintf(request, template, path, port);
+
+    // server's address
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // allow as many connections as permitted
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    // create event loop
+#ifdef __linux__
+    efd = epoll_create1(EPOLL_CLOEXEC);
+#else
+    efd = kqueue();
+#endif
+    if (efd == -1)
+    {
+        perror("loadgen");
+        return 1;
+    }
+
+    // open connections
+    struct connection* pool = calloc(connections, sizeof(struct connection));
+    if (pool == NULL)
+    {
+        return 1;
+    }
+    for (int i = 0; i < connections; i++)
+    {
+        if (!begin(&pool[i]))
+        {
+            perror("loadgen");
+            return 1;
+        }
+    }
+
+    // send requests (one at a time per connection) until time is up, retrying
+    // (every millisecond or so) connections that couldn't reconnect
+    fewest = connections;
+    long long deadline = now() + (long long) (seconds * 1000000);
+    long long start = now();
+    while (now() < deadline)
+    {
+        void* data[EVENTS];
+        int n = ready(data, EVENTS, (down > 0) ? 1 : (deadline - now()) / 1000 + 1);
+        for (int i = 0; i < n; i++)
+        {
+            progress(data[i]);
+        }
+        fewest = (connections - down < fewest) ? connections - down : fewest;
+        for (int i = 0; i < connections && down > 0; i++)
+        {
+            if (pool[i].fd == -1 && begin(&pool[i]))
+            {
+                down--;
+            }
+        }
+    }
+    double elapsed = (now() - start) / 1000000.0;
+
+    // report results
+    report(name, path, connections, elapsed);
+
+    // close connections
+    for (int i = 0; i < connections; i++)
+    {
+        if (pool[i].fd != -1)
+        {
+            close(pool[i].fd);
+        }
+    }
+    free(pool);
+    free(request);
+    free(latencies);
+    close(efd);
+    return 0;
+}
+
+/**
+ * Connects (without blocking) to server, resetting connection's state.
+ * Returns true iff successful.
+ */
+bool begin(struct connection* c)
+{
+    memset(c, 0, sizeof(*c));
+    c->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c->fd == -1)
+    {
+        return false;
+    }
+    int one = 1;
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (fcntl(c->fd, F_SETFL, O_NONBLOCK) == -1 || !watch(c->fd, c))
+    {
+        close(c->fd);
+        c->fd = -1;
+        return false;
+    }
+    if (connect(c->fd, (struct sockaddr*) &address, sizeof(address)) == -1 && errno != EINPROGRESS)
+    {
+        close(c->fd);
+        c->fd = -1;
+        return false;
+    }
+    c->state = CONNECTING;
+    return true;
+}
+
+/**
+ * Records completion of connection's response, then sends another request,
+ * reconnecting if server is to close connection.
+ */
+void complete(struct connection* c)
+{
+    // record status, and latency unless response is a refusal
+    if (c->status != 503 && samples == capacity)
+    {
+        size_t n = (capacity == 0) ? 65536 : capacity * 2;
+        unsigned int* p = realloc(latencies, n * sizeof(unsigned int));
+        if (p == NULL)
+        {
+            fail(c);
+            return;
+        }
+        latencies = p;
+        capacity = n;
+    }
+    if (c->status != 503)
+    {
+        latencies[samples++] = now() - c->started;
+    }
+    statuses[(c->status >= 100 && c->status < 600) ? c->status : 0]++;
+
+    // reconnect if server is to close connection
+    if (c->closing)
+    {
+        reconnect(c);
+        return;
+    }
+
+    // send next request
+    c->state = SENDING;
+    c->sent = 0;
+    c->length = 0;
+    c->status = 0;
+    c->headed = c->chunked = c->last = false;
+    c->remaining = 0;
+    progress(c);
+}
+
+/**
+ * Compares two latencies, for qsort.
+ */
+int compare(const void* a, const void* b)
+{
+    unsigned int x = *(const unsigned int*) a, y = *(const unsigned int*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Parses as much of connection's buffered response as possible, consuming it.
+ * Returns true iff response is complete, else false, in which case connection
+ * is to be read from again.
+ */
+bool consume(struct connection* c)
+{
+    size_t offset = 0;
+    while (true)
+    {
+        // skip body (or current chunk)
+        if (c->remaining > 0)
+        {
+            size_t n = (c->length - offset < (size_t) c->remaining) ? c->length - offset : c->remaining;
+            offset += n;
+            c->remaining -= n;
+            if (c->remaining > 0)
+            {
+                break;
+            }
+            if (!c->chunked)
+            {
+                break;
+            }
+        }
+        if (!c->chunked)
+        {
+            break;
+        }
+
+        // parse chunk-size (preceded by CRLF that ended previous chunk, if any),
+        // or CRLF that ends chunked body (which has no trailer)
+        char* line = memmem(c->buffer + offset, c->length - offset, "\r\n", 2);
+        if (line == NULL)
+        {
+            break;
+        }
+        if (line == c->buffer + offset)
+        {
+            offset += 2;
+            if (c->last)
+            {
+                c->chunked = false;
+                break;
+            }
+            continue;
+        }
+        c->remaining = strtoll(c->buffer + offset, NULL, 16);
+        offset = line + 2 - c->buffer;
+        if (c->remaining == 0)
+        {
+            c->last = true;
+        }
+    }
+
+    // keep whatever remains unparsed
+    memmove(c->buffer, c->buffer + offset, c->length - offset);
+    c->length -= offset;
+    return !c->chunked && c->remaining == 0;
+}
+
+/**
+ * Counts a failure, reconnecting to server.
+ */
+void fail(struct connection* c)
+{
+    errors++;
+    reconnect(c);
+}
+
+/**
+ * Parses response's headers, if buffered in their entirety, consuming them.
+ * Returns true iff parsed.
+ */
+bool headers(struct connection* c)
+{
+    char* end = memmem(c->buffer, c->length, "\r\n\r\n", 4);
+    if (end == NULL)
+    {
+        return false;
+    }
+    *end = '\0';
+
+    // parse Status-Line
+    c->status = (strncmp(c->buffer, "HTTP/1.", 7) == 0) ? atoi(c->buffer + 9) : 0;
+
+    // parse headers that determine body's length and connection's persistence
+    c->remaining = 0;
+    for (char* line = strstr(c->buffer, "\r\n"); line != NULL; line = strstr(line, "\r\n"))
+    {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0)
+        {
+            c->remaining = atoll(line + 15);
+        }
+        else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0 && strstr(line, "chunked") != NULL)
+        {
+            c->chunked = true;
+        }
+        else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line, "close") != NULL)
+        {
+            c->closing = true;
+        }
+    }
+
+    // consume headers
+    c->length -= end + 4 - c->buffer;
+    memmove(c->buffer, end + 4, c->length);
+    c->headed = true;
+    return true;
+}
+
+/**
+ * Returns current time in microseconds.
+ */
+long long now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+/**
+ * Advances connection as far as it can go without blocking.
+ */
+void progress(struct connection* c)
+{
+    // ensure connection succeeded
+    if (c->state == CONNECTING)
+    {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &error, &length) == -1 || error != 0)
+        {
+            fail(c);
+            return;
+        }
+        c->state = SENDING;
+    }
+
+    // write request
+    if (c->state == SENDING)
+    {
+        if (c->sent == 0)
+        {
+            c->started = now();
+        }
+        while (c->sent < size)
+        {
+            ssize_t bytes = write(c->fd, request + c->sent, size - c->sent);
+            if (bytes == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    return;
+                }
+                if (errno != EINTR)
+                {
+                    fail(c);
+                    return;
+                }
+                continue;
+            }
+            c->sent += bytes;
+        }
+        c->state = RECEIVING;
+    }
+
+    // read response
+    while (c->state == RECEIVING)
+    {
+        ssize_t bytes = read(c->fd, c->buffer + c->length, sizeof(c->buffer) - c->length);
+        if (bytes == -1)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return;
+            }
+            if (errno != EINTR)
+            {
+                fail(c);
+                return;
+            }
+            continue;
+        }
+
+        // server closed connection before response was complete
+        if (bytes == 0)
+        {
+            fail(c);
+            return;
+        }
+        c->length += bytes;
+        received += bytes;
+
+        // parse response
+        if (!c->headed)
+        {
+            if (!headers(c))
+            {
+                // give up on headers that won't fit in buffer
+                if (c->length == sizeof(c->buffer))
+                {
+                    fail(c);
+                }
+                continue;
+            }
+        }
+        if (consume(c))
+        {
+            complete(c);
+            return;
+        }
+    }
+}
+
+/**
+ * Waits (up to timeout milliseconds) for watched sockets to become ready,
+ * storing up to max of their data in data. Returns number ready.
+ */
+int ready(void** data, int max, int timeout)
+{
+#ifdef __linux__
+    struct epoll_event events[max];
+    int n = epoll_wait(efd, events, max, timeout);
+    for (int i = 0; i < n; i++)
+    {
+        data[i] = events[i].data.ptr;
+    }
+#else
+    struct kevent events[max];
+    struct timespec ts = {timeout / 1000, (timeout % 1000) * 1000000};
+    int n = kevent(efd, NULL, 0, events, max, &ts);
+    for (int i = 0; i < n; i++)
+    {
+        data[i] = events[i].udata;
+    }
+#endif
+    return n;
+}
+
+/**
+ * Closes connection, then connects anew, counting a failure (and leaving connection
+ * down, to be retried) if it can't.
+ */
+void reconnect(struct connection* c)
+{
+    close(c->fd);
+    if (!begin(c))
+    {
+        errors++;
+        down++;
+    }
+}
+
+/**
+ * Prints results as a JSON object on one line, with requests (and their rate and
+ * latencies) excluding refusals, which are counted (and warned of) on their own,
+ * as are connections that weren't open all the while.
+ */
+void report(const char* name, const char* path, int connections, double seconds)
+{
+    // determine percentiles
+    qsort(latencies, samples, sizeof(unsigned int), compare);
+    unsigned int p50 = 0, p99 = 0, p999 = 0, max = 0;
+    if (samples > 0)
+    {
+        p50 = latencies[(size_t) (samples * 0.5)];
+        p99 = latencies[(size_t) (samples * 0.99)];
+        p999 = latencies[(size_t) (samples * 0.999)];
+        max = latencies[samples - 1];
+    }
+
+    // warn of refusals, lest server's limits (rather than server) be measured
+    if (statuses[503] > 0)
+    {
+        fprintf(stderr, "loadgen: %s: %lu responses refused with 503\n", name, statuses[503]);
+    }
+    if (fewest < connections)
+    {
+        fprintf(stderr, "loadgen: %s: only %i of %i connections open at times\n", name, fewest, connections);
+    }
+
+    printf("{\"name\": \"%s\", \"path\": \"%s\", \"connections\": %i, \"live\": %i, \"seconds\": %.2f, "
+        "\"requests\": %zu, \"errors\": %lu, \"refused\": %lu, \"requests_per_second\": %.1f, \"bytes_per_second\": %.0f, "
+        "\"latency_us\": {\"p50\": %u, \"p99\": %u, \"p999\": %u, \"max\": %u}, \"statuses\": {",
+        name, path, connections, fewest, seconds, samples, errors, statuses[503], samples / seconds, received / seconds,
+        p50, p99, p999, max);
+    bool first = true;
+    for (int i = 0; i < 600; i++)
+    {
+        if (statuses[i] > 0)
+        {
+            printf("%s\"%i\": %lu", first ? "" : ", ", i, statuses[i]);
+            first = false;
+        }
+    }
+    printf("}}\n");
+}
+
+/**
+ * Watches socket for readiness (edge-triggered) to be read from or written to,
+ * associating data therewith. Returns true iff successful.
+ */
+bool watch(int fd, void* data)
+{
+#ifdef __linux__
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    event.data.ptr = data;
+    return epoll_ctl(efd, EPOLL_CTL_ADD, fd, &event) == 0;
+#else
+    struct kevent events[2];
+    EV_SET(&events[0], fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, data);
+    EV_SET(&events[1], fd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, data);
+    return kevent(efd, events, 2, NULL, 0, NULL) == 0;
+#endif
+}
@@ -0,0 +1,218 @@
+/****************************************************************************
+ *
+ * Microbenchmark for server's parsers, decoders, and encoders, reporting
+ * nanoseconds per call (e.g., per request parsed) and throughput as JSON
+ * Usage: microbench [-d seconds]
+ *
+ ***************************************************************************/
+
+// server's functions, without its main
+#define HARNESS
+#include "server.c"
+
+// a workload: a function of server's, run repeatedly on the same input
+struct workload
+{
+    const char* name;
+    size_t (*function)(const char* s, size_t n, char* t);
+    char* input;
+    size_t length;
+};
+
+// prototypes
+char* generate(size_t length, size_t every, const char* insert);
+size_t parsing(const char* s, size_t n, char* t);
+double stopwatch(void);
+void trial(const struct workload* w, double seconds);
+
+// sum of functions' results, so that calls can't be optimized away
+volatile size_t sink = 0;
+
+// requests' headers as sent by a browser, by curl, and by a browser with cookies
+// and a long query string, respectively
+const char* browser =
+    "GET /assets/app.js HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"128\", \"Not;A=Brand\";v=\"24\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/128.0.0.0 Safari/537.36\r\n"
+    "sec-ch-ua-platform: \"Linux\"\r\n"
+    "Accept: */*\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Dest: script\r\n"
+    "Referer: https://www.example.com/\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "If-None-Match: \"ede01b-bde34-6acf0e5e-br\"\r\n"
+    "\r\n";
+const char* curl =
+    "GET /hello.html HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: curl/8.5.0\r\n"
+    "Accept: */*\r\n"
+    "\r\n";
+const char* cookies =
+    "GET /search.php?q=web+server+in+c&page=2&sort=relevance&utm_source=newsletter&utm_medium=email HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10.15; rv:130.0) Gecko/20100101 Firefox/130.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=8f3a2c1e9b7d4f6a0c5e2b8d1f4a7c3e; theme=dark; _ga=GA1.2.1234567890.1700000000; "
+    "_gid=GA1.2.987654321.1700000000; consent=analytics%2Cads\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-Site: none\r\n"
+    "Sec-Fetch-User: ?1\r\n"
+    "Priority: u=0, i\r\n"
+    "\r\n";
+
+int main(int argc, char* argv[])
+{
+    // default to 1 second per workload
+    double seconds = 1;
+
+    // parse command-line arguments
+    int opt;
+    while ((opt = getopt(argc, argv, "d:h")) != -1)
+    {
+        switch (opt)
+        {
+            // -d seconds
+            case 'd':
+                seconds = atof(optarg);
+                break;
+
+            // -h
+            case 'h':
+                printf("Usage: microbench [-d seconds]\n");
+                return 0;
+        }
+    }
+
+    // requests' headers, parsed (along with their request-lines) as they arrive,
+    // absolute-paths with nothing to decode, with sparse encodings (as in a long
+    // query string), and with dense ones, plus names of directory entries with
+    // nothing to escape and with sprinklings of characters to escape
+    struct workload workloads[] =
+    {
+        {"request:browser", parsing, strdup(browser), strlen(browser)},
+        {"request:curl", parsing, strdup(curl), strlen(curl)},
+        {"request:cookies", parsing, strdup(cookies), strlen(cookies)},
+        {"urldecode:plain", urldecode, generate(1024, 0, ""), 1024},
+        {"urldecode:sparse", urldecode, generate(8192, 64, "%20"), 8192},
+        {"urldecode:dense", urldecode, generate(1024, 4, "%2F+"), 1024},
+        {"htmlspecialchars:plain", htmlspecialchars, generate(255, 0, ""), 255},
+        {"htmlspecialchars:special", htmlspecialchars, generate(255, 16, "<&>"), 255}
+    };
+    int n = sizeof(workloads) / sizeof(workloads[0]);
+
+    // run workloads
+    printf("[\n");
+    for (int i = 0; i < n; i++)
+    {
+        if (workloads[i].input == NULL)
+        {
+            return 1;
+        }
+        trial(&workloads[i], seconds);
+        printf("%s\n", (i + 1 < n) ? "," : "");
+        free(workloads[i].input);
+    }
+    printf("]\n");
+    return 0;
+}
+
+/**
+ * Generates length bytes of path-like text, with insert in place of every
+ * every-th run thereof (unless every is 0). Returns text, else NULL.
+ */
+char* generate(size_t length, size_t every, const char* insert)
+{
+    char* s = malloc(length + 1);
+    if (s == NULL)
+    {
+        return NULL;
+    }
+    const char* alphabet = "abcdefghijklmnopqrstuvwxyz0123456789/._-";
+    for (size_t i = 0; i < length; i++)
+    {
+        s[i] = alphabet[(i * 7) % strlen(alphabet)];
+    }
+    for (size_t i = every; every > 0 && i + strlen(insert) <= length; i += every)
+    {
+        memcpy(s + i, insert, strlen(insert));
+    }
+    s[length] = '\0';
+    return s;
+}
+
+/**
+ * Parses n bytes of s as a request's headers, as though just read from a client,
+ * then its request-line, into t, which must have room for its absolute-path and
+ * query (i.e., for 2 * (LimitRequestLine + 1) bytes). Returns number of fields.
+ */
+size_t parsing(const char* s, size_t n, char* t)
+{
+    static struct connection c;
+    memset(&c.parsed, 0, sizeof(c.parsed));
+    c.fd = -1;
+    c.message = (char*) s;
+    c.length = n;
+    if (!request(&c) || c.parsed.invalid != 0 || !parse(&c, t, t + LimitRequestLine + 1))
+    {
+        return 0;
+    }
+    return c.parsed.fields;
+}
+
+/**
+ * Returns monotonic time in seconds.
+ */
+double stopwatch(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Runs workload for about seconds, in batches, printing its result as JSON.
+ */
+void trial(const struct workload* w, double seconds)
+{
+    // output may be up to 6 times as long as input (if every byte is escaped),
+    // or as long as a request-line's absolute-path and query (if parsed)
+    size_t size = w->length * strlen("&quot;") + 1;
+    char* t = malloc((size > 2 * (LimitRequestLine + 1)) ? size : 2 * (LimitRequestLine + 1));
+    if (t == NULL)
+    {
+        return;
+    }
+
+    // warm up, then time batches until time is up
+    size_t calls = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        sink += w->function(w->input, w->length, t);
+    }
+    double start = stopwatch(), elapsed = 0;
+    do
+    {
+        for (int i = 0; i < 10000; i++)
+        {
+            sink += w->function(w->input, w->length, t);
+        }
+        calls += 10000;
+        elapsed = stopwatch() - start;
+    }
+    while (elapsed < seconds);
+    free(t);
+
+    printf("{\"name\": \"%s\", \"bytes\": %zu, \"calls\": %zu, \"ns_per_call\": %.1f, \"bytes_per_second\": %.0f}",
+        w->name, w->length, calls, elapsed * 1e9 / calls, w->length * calls / elapsed);
+}
@@ -0,0 +1,234 @@
+/****************************************************************************
+ *
+ * Generates mime.h, a minimal perfect hash of extensions to MIME types,
+ * from a file in the format of Apache's mime.types
+ * Usage: mimegen < mime.types > mime.h
+ *
+ ***************************************************************************/
+
+// feature test macro requirements
+#define _GNU_SOURCE
+#define _XOPEN_SOURCE 700
+#define _XOPEN_SOURCE_EXTENDED
+
+// max length of an extension, beyond which extensions are rejected
+#define MIME_EXTENSION_MAX 15
+
+// number of bytes for buffers
+#define BYTES 512
+
+// header files
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// an extension and its MIME type
+struct mime
+{
+    char* extension;
+    char* type;
+    unsigned int bucket;
+};
+
+// prototypes
+int compare(const void* a, const void* b);
+unsigned int mimehash(const char* s, unsigned int seed);
+
+// extensions and their number
+struct mime* mimes = NULL;
+size_t n = 0;
+
+// number of extensions in each bucket, by which to sort them
+unsigned int* sizes = NULL;
+
+int main(void)
+{
+    // parse lines of types, each followed by extensions
+    char line[BYTES * 2];
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        char* comment = strchr(line, '#');
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+        char* type = strtok(line, " \t\r\n");
+        if (type == NULL)
+        {
+            continue;
+        }
+        for (char* extension = strtok(NULL, " \t\r\n"); extension != NULL; extension = strtok(NULL, " \t\r\n"))
+        {
+            // lowercase extension
+            if (strlen(extension) > MIME_EXTENSION_MAX)
+            {
+                fprintf(stderr, "mimegen: extension too long: %s\n", extension);
+                return 1;
+            }
+            for (char* p = extension; *p != '\0'; p++)
+            {
+                *p = tolower((unsigned char) *p);
+            }
+
+            // keep first type for each extension
+            bool duplicate = false;
+            for (size_t i = 0; i < n && !duplicate; i++)
+            {
+                duplicate = (strcmp(mimes[i].extension, extension) == 0);
+            }
+            if (duplicate)
+            {
+                continue;
+            }
+
+            // remember extension
+            struct mime* m = realloc(mimes, (n + 1) * sizeof(struct mime));
+            if (m == NULL)
+            {
+                return 1;
+            }
+            mimes = m;
+            mimes[n].extension = strdup(extension);
+            mimes[n].type = strdup(type);
+            if (mimes[n].extension == NULL || mimes[n].type == NULL)
+            {
+                return 1;
+            }
+            n++;
+        }
+    }
+    if (n == 0)
+    {
+        fprintf(stderr, "mimegen: no types\n");
+        return 1;
+    }
+
+    // hash extensions into as many buckets as there are extensions
+    sizes = calloc(n, sizeof(unsigned int));
+    if (sizes == NULL)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        mimes[i].bucket = mimehash(mimes[i].extension, 0) % n;
+        sizes[mimes[i].bucket]++;
+    }
+
+    // place largest buckets first, while most slots are free
+    qsort(mimes, n, sizeof(struct mime), compare);
+
+    // for each bucket, find a seed that hashes its extensions to free slots
+    // (the seed being the bucket's displacement)
+    unsigned int* displacements = calloc(n, sizeof(unsigned int));
+    struct mime** slots = calloc(n, sizeof(struct mime*));
+    unsigned int* tried = calloc(n, sizeof(unsigned int));
+    if (displacements == NULL || slots == NULL || tried == NULL)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < n; )
+    {
+        // extensions i through j - 1 share a bucket
+        size_t j = i;
+        while (j < n && mimes[j].bucket == mimes[i].bucket)
+        {
+            j++;
+        }
+        for (unsigned int seed = 1; ; seed++)
+        {
+            // ensure bucket's extensions hash to distinct free slots
+            bool fits = true;
+            for (size_t k = i; k < j && fits; k++)
+            {
+                unsigned int slot = mimehash(mimes[k].extension, seed) % n;
+                fits = (slots[slot] == NULL && tried[slot] != seed);
+                tried[slot] = seed;
+            }
+            for (size_t k = i; k < j; k++)
+            {
+                tried[mimehash(mimes[k].extension, seed) % n] = 0;
+            }
+            if (!fits)
+            {
+                continue;
+            }
+            for (size_t k = i; k < j; k++)
+            {
+                slots[mimehash(mimes[k].extension, seed) % n] = &mimes[k];
+            }
+            displacements[mimes[i].bucket] = seed;
+            break;
+        }
+        i = j;
+    }
+
+    // emit header
+    printf("// generated by mimegen from mime.types, which is to be edited instead\n\n");
+    printf("// max length of an extension, and number of extensions\n");
+    printf("#define MIME_EXTENSION_MAX %i\n", MIME_EXTENSION_MAX);
+    printf("#define MIME_EXTENSIONS %zu\n\n", n);
+    printf("// hashes lowercased extension with seed (FNV-1a, then finalized)\n");
+    printf("static inline unsigned int mimehash(const char* s, unsigned int seed)\n");
+    printf("{\n");
+    printf("    unsigned int h = 2166136261u ^ (seed * 2654435761u);\n");
+    printf("    for (; *s != '\\0'; s++)\n");
+    printf("    {\n");
+    printf("        h = (h ^ (unsigned char) *s) * 16777619u;\n");
+    printf("    }\n");
+    printf("    h ^= h >> 16;\n");
+    printf("    h *= 2246822507u;\n");
+    printf("    h ^= h >> 13;\n");
+    printf("    return h;\n");
+    printf("}\n\n");
+    printf("// seed with which to rehash extensions in each bucket\n");
+    printf("static const unsigned int displacements[MIME_EXTENSIONS] =\n{");
+    for (size_t i = 0; i < n; i++)
+    {
+        printf("%s%u", (i % 16 == 0) ? "\n    " : " ", displacements[i]);
+        printf("%s", (i + 1 < n) ? "," : "\n");
+    }
+    printf("};\n\n");
+    printf("// extensions and their MIME types, each in its own slot\n");
+    printf("static const struct\n{\n    const char* extension;\n    const char* type;\n}\n");
+    printf("mimes[MIME_EXTENSIONS] =\n{\n");
+    for (size_t i = 0; i < n; i++)
+    {
+        printf("    {\"%s\", \"%s\"}%s\n", slots[i]->extension, slots[i]->type, (i + 1 < n) ? "," : "");
+    }
+    printf("};\n");
+    return 0;
+}
+
+/**
+ * Compares two extensions by their buckets' sizes (largest first), then by bucket,
+ * for qsort.
+ */
+int compare(const void* a, const void* b)
+{
+    const struct mime* x = a;
+    const struct mime* y = b;
+    if (sizes[x->bucket] != sizes[y->bucket])
+    {
+        return (sizes[x->bucket] < sizes[y->bucket]) ? 1 : -1;
+    }
+    return (x->bucket > y->bucket) - (x->bucket < y->bucket);
+}
+
+/**
+ * Hashes s with seed, just as mime.h's mimehash does.
+ */
+unsigned int mimehash(const char* s, unsigned int seed)
+{
+    unsigned int h = 2166136261u ^ (seed * 2654435761u);
+    for (; *s != '\0'; s++)
+    {
+        h = (h ^ (unsigned char) *s) * 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 2246822507u;
+    h ^= h >> 13;
+    return h;
+}
@@ -1,7 +1,7 @@
 /****************************************************************************
  *
  * Web Server in C that serves static and dynamic content
- * Usage: server [-p port] /path/to/root
+ * Usage: server [-a log [-j] [-s n]] [-C certificate.pem [-K key.pem]] [-f socket] [-l address]... [-m megabytes] [-N connections] [-n connections] [-p port] [-S] [-t mime.types] [-w workers [-c]] /path/to/root
  * 
  ***************************************************************************/
 
@@ -16,59 +16,1109 @@
 #define LimitRequestFieldSize 4094
 #define LimitRequestLine 8190
 
+// limits on a persistent connection, again based on Apache's
+// http://httpd.apache.org/docs/2.2/mod/core.html#keepalivetimeout
+#define KeepAliveTimeout 5
+#define MaxKeepAliveRequests 100
+
+// limits on how long a client may take to send a request's headers (once it's begun)
+// and to accept more of a response, based on Apache's mod_reqtimeout and Timeout
+// http://httpd.apache.org/docs/2.4/mod/mod_reqtimeout.html#requestreadtimeout
+// http://httpd.apache.org/docs/2.4/mod/core.html#timeout
+#define RequestReadTimeout 20
+#define Timeout 60
+
+// limits on connections open at once, per worker and per client's address (within
+// a worker), beyond which clients are refused, by default (unless -n or -N says
+// otherwise), based on nginx's worker_connections and limit_conn
+// http://nginx.org/en/docs/ngx_core_module.html#worker_connections
+// http://nginx.org/en/docs/http/ngx_http_limit_conn_module.html
+#define WorkerConnections 4096
+#define LimitConnPerAddress 256
+
+// limits on clients yet to be accepted over TCP: how long (in seconds) kernel may hold
+// one back until its request arrives, and how many may be pending with requests sent
+// within their SYNs (via TCP Fast Open), based on nginx's deferred and fastopen
+// http://nginx.org/en/docs/http/ngx_http_core_module.html#listen
+#define DeferAccept 1
+#define FastOpen 256
+
+// limits on files cached in memory, based on Apache's mod_cache
+// http://httpd.apache.org/docs/2.2/mod/mod_disk_cache.html#cachemaxfilesize
+#define CacheMaxFileSize 1000000
+#define CacheSize 64
+
+// limit on ranges per request, beyond which Range is ignored, based on Apache's
+// http://httpd.apache.org/docs/2.4/mod/core.html#maxranges
+#define MaxRanges 200
+
+// number of paths whose resolutions (including to nothing) are cached,
+// beyond which cache thereof starts over
+#define CacheRoutes 4096
+
+// levels at which responses are compressed on the fly (just once per cached file,
+// since compressed copies are cached too), based on Apache's mod_deflate and mod_brotli
+// http://httpd.apache.org/docs/2.4/mod/mod_deflate.html#deflatecompressionlevel
+// http://httpd.apache.org/docs/2.4/mod/mod_brotli.html#brotlicompressionquality
+#define DeflateCompressionLevel 6
+#define BrotliCompressionQuality 5
+
+// limits on connections to FastCGI backends, per process, based on
+// Apache's mod_proxy_fcgi (whose connections are likewise reused)
+// http://httpd.apache.org/docs/2.4/mod/mod_proxy.html#proxypass
+#define FastCGIConnections 16
+
+// FastCGI's version, record types, role, and flags
+// http://www.mit.edu/~yandros/doc/specs/fcgi-spec.html
+#define FCGI_VERSION_1 1
+#define FCGI_BEGIN_REQUEST 1
+#define FCGI_END_REQUEST 3
+#define FCGI_PARAMS 4
+#define FCGI_STDIN 5
+#define FCGI_STDOUT 6
+#define FCGI_STDERR 7
+#define FCGI_RESPONDER 1
+#define FCGI_KEEP_CONN 1
+#define FCGI_REQUEST_COMPLETE 0
+
+// limit on streams open at once per HTTP/2 connection, beyond which streams are
+// refused, based on nginx's
+// http://nginx.org/en/docs/http/ngx_http_v2_module.html#http2_max_concurrent_streams
+#define Http2MaxConcurrentStreams 128
+
+// HTTP/2's frame types (plus RFC 9218's PRIORITY_UPDATE), flags, settings, and error codes
+// https://tools.ietf.org/html/rfc7540#section-6
+// https://tools.ietf.org/html/rfc9218#section-7.1
+#define HTTP2_DATA 0x0
+#define HTTP2_HEADERS 0x1
+#define HTTP2_PRIORITY 0x2
+#define HTTP2_RST_STREAM 0x3
+#define HTTP2_SETTINGS 0x4
+#define HTTP2_PUSH_PROMISE 0x5
+#define HTTP2_PING 0x6
+#define HTTP2_GOAWAY 0x7
+#define HTTP2_WINDOW_UPDATE 0x8
+#define HTTP2_CONTINUATION 0x9
+#define HTTP2_PRIORITY_UPDATE 0x10
+#define HTTP2_ACK 0x1
+#define HTTP2_END_STREAM 0x1
+#define HTTP2_END_HEADERS 0x4
+#define HTTP2_PADDED 0x8
+#define HTTP2_PRIORITY_FLAG 0x20
+#define HTTP2_SETTINGS_ENABLE_PUSH 0x2
+#define HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS 0x3
+#define HTTP2_SETTINGS_INITIAL_WINDOW_SIZE 0x4
+#define HTTP2_SETTINGS_MAX_FRAME_SIZE 0x5
+#define HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE 0x6
+#define HTTP2_NO_ERROR 0x0
+#define HTTP2_PROTOCOL_ERROR 0x1
+#define HTTP2_FLOW_CONTROL_ERROR 0x3
+#define HTTP2_FRAME_SIZE_ERROR 0x6
+#define HTTP2_REFUSED_STREAM 0x7
+#define HTTP2_CANCEL 0x8
+#define HTTP2_COMPRESSION_ERROR 0x9
+#define HTTP2_ENHANCE_YOUR_CALM 0xb
+
 // number of bytes for buffers
 #define BYTES 512
 
+// number of bytes in each connection's buffer, which must hold a request's
+// headers in their entirety (plus any bytes pipelined after them)
+#define BUFFER 16384
+
+// number of bytes in each connection's arena, from which memory that lasts no longer
+// than a request is allocated, and number of spare arenas and connections (each with
+// its buffers) to keep for reuse rather than free
+#define ARENA 8192
+#define SPARES 256
+
+// length of a body that's to follow in chunks, its length unknown in advance
+// https://tools.ietf.org/html/rfc7230#section-4.1
+#define CHUNKED SIZE_MAX
+
+// number of bytes in an HTTP/2 frame's payload at most (the default, per
+// SETTINGS_MAX_FRAME_SIZE, which server neither raises nor exceeds), in each HTTP/2
+// connection's table of header fields (the default, per SETTINGS_HEADER_TABLE_SIZE),
+// and in each stream's (and connection's) window initially
+// https://tools.ietf.org/html/rfc7540#section-6.5.2
+#define FRAME 16384
+#define TABLE 4096
+#define WINDOW 65535
+
+// number of bytes of frames that each HTTP/2 connection queues before writing them,
+// beyond which its streams wait for client to accept some, so that streams take
+// turns at connection in slices of about this size
+#define QUEUE (FRAME * 4)
+
+// number of readiness events to handle per iteration of event loop
+#define EVENTS 64
+
+// number of slots in timer wheel of connections' deadlines, and number of milliseconds
+// spanned by each, such that wheel spans longer than any deadline is ever away
+#define SLOTS 256
+#define TICK 250
+
+// number of entries in each process's io_uring, and number of threads per process
+// that instead perform blocking file-system operations where io_uring isn't available
+#define ENTRIES 256
+#define THREADS 4
+
+// number of buckets per power of two in each histogram of latencies (in nanoseconds),
+// whose buckets thus bound latencies to within 25% (as HdrHistogram's would), and
+// number of buckets in all, enough for latencies of up to 2^40 ns (about 18 minutes)
+#define SUBBUCKETS 4
+#define BUCKETS 156
+
+// number of notes (i.e., requests' entries in access log, as yet unformatted) that
+// each process's ring holds, beyond which notes are dropped until some are written,
+// and number of milliseconds between batches thereof being written
+#define NOTES 4096
+#define PERIOD 10
+
 // header files
 #include <arpa/inet.h>
+#include <ctype.h>
 #include <dirent.h>
 #include <errno.h>
 #include <limits.h>
 #include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <time.h>
 #include <unistd.h>
 
+// SIMD instructions with which to scan requests, where available
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// event notification facility: epoll on Linux, kqueue on BSD
+#ifdef __linux__
+#include <sched.h>
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#else
+#include <sys/event.h>
+#endif
+
+// compression libraries, for gzip and br content-codings
+#include <brotli/encode.h>
+#include <zlib.h>
+
+// TLS library, for HTTPS (and for random IDs of traces)
+#include <openssl/err.h>
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+
+// USDT probes (for, e.g., bpftrace or perf), where systemtap's header is available,
+// else none
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#endif
+#endif
+#ifndef DTRACE_PROBE3
+#define DTRACE_PROBE3(provider, name, a, b, c)
+#define DTRACE_PROBE5(provider, name, a, b, c, d, e)
+#endif
+
+// built-in MIME types, as generated from mime.types by mimegen
+#include "mime.h"
+
 // types
 typedef char BYTE;
 
+// kinds of descriptors (other than inotify's and jobs') watched by event loop,
+// the structs for each of which begin with their kind
+enum kind
+{
+    CLIENT,
+    BACKEND,
+    LISTENER
+};
+
+// stages of requests' handling, each of whose latencies is measured: parsing
+// headers, resolving path (from cache, if possible), performing a job's file I/O,
+// awaiting PHP, writing response, and all of request, from parsing through writing
+enum stage
+{
+    PARSE,
+    RESOLVE,
+    IO,
+    PHP,
+    WRITE,
+    REQUEST,
+    STAGES
+};
+
+// states through which a connection progresses
+enum state
+{
+    // reading request's headers
+    READING,
+
+    // dispatching request to its handler
+    DISPATCHING,
+
+    // waiting for a backend's response
+    WAITING,
+
+    // writing response
+    WRITING,
+
+    // closing connection
+    CLOSING
+};
+
+// content-codings in which a response can be sent, from least preferred to most
+// https://tools.ietf.org/html/rfc7231#section-3.1.2.1
+enum coding
+{
+    IDENTITY,
+    GZIP,
+    BROTLI,
+    CODINGS
+};
+
+// a file cached in memory, along with what's needed to respond with it
+struct entry
+{
+    // file's resolved path and hash thereof
+    char* path;
+    unsigned long hash;
+
+    // file's identity and metadata, as of when cached, against which entry
+    // is validated on each hit unless inotify is watching for changes, and
+    // from which its validators (e.g., ETag) derive
+    struct stat sb;
+    bool watched;
+
+    // file's MIME type, along with response's headers (other than Content-Length
+    // and Connection) and body in each content-coding (NULL unless encoded
+    // therein), and whether each coding has been tried
+    const char* type;
+    char* headers[CODINGS];
+    BYTE* body[CODINGS];
+    size_t length[CODINGS];
+    bool tried[CODINGS];
+
+    // number of references to entry, by cache itself and by connections
+    // still sending it, whether cache still holds entry, and whether entry's
+    // instead part of a snapshot (and so is neither evicted nor within budget)
+    int references;
+    bool cached;
+    bool packed;
+
+    // next entry in same bucket, and neighbors in list of entries from
+    // most recently used to least recently used
+    struct entry* chain;
+    struct entry* hotter;
+    struct entry* colder;
+};
+
+// what a path resolves to: a file (perhaps a directory's index), a directory
+// to be listed, a redirect (from directory to directory/), or nothing at all
+enum target
+{
+    REGULAR,
+    LISTING,
+    RELOCATION,
+    NOTHING
+};
+
+// a path's resolution, cached until inotify reports a change to it
+struct route
+{
+    // path (i.e., root plus request's absolute-path) and hash thereof
+    char* path;
+    unsigned long hash;
+
+    // what path resolves to and, if a file, that file's path and MIME type,
+    // along with its entry, if route's part of a snapshot
+    enum target target;
+    char* file;
+    const char* type;
+    struct entry* entry;
+
+    // whether cache holds route, and next route in same bucket
+    bool cached;
+    struct route* chain;
+};
+
+// a slice of a connection's buffer, as an offset therein and a length
+struct slice
+{
+    unsigned short start;
+    unsigned short length;
+};
+_Static_assert(BUFFER <= USHRT_MAX, "slices can't address all of buffer");
+
+// a request's headers, as parsed (incrementally, in place) from connection's buffer
+struct headers
+{
+    // offset of line to be parsed next, and offset up to which it's been scanned
+    size_t line;
+    size_t scanned;
+
+    // offset just past headers' final CRLF, once found, else 0
+    size_t end;
+
+    // request-line (sans CRLF), once found
+    struct slice request;
+
+    // header fields' names and values (sans surrounding whitespace)
+    struct slice names[LimitRequestFields];
+    struct slice values[LimitRequestFields];
+    int fields;
+
+    // status code with which to reject request, if invalid, else 0
+    unsigned short invalid;
+};
+
+// phases of a job, each an asynchronous file-system operation
+enum phase
+{
+    OPENING,
+    STATING,
+    LOADING,
+    DONE
+};
+
+// an opening (and, if small enough to cache, reading) of a file for a client, which
+// waits meanwhile, performed asynchronously (via io_uring, else by a thread) so that
+// event loop needn't block on disk
+struct job
+{
+    // client waiting for job (NULL if it's since hung up), file's path and its MIME type
+    struct connection* client;
+    char* path;
+    const char* type;
+
+    // job's phase, file's descriptor and metadata (as reported by statx, if via
+    // io_uring), errno if file couldn't be opened, and its content (if read) and
+    // number of bytes thereof read thus far
+    enum phase phase;
+    int file;
+#ifdef __linux__
+    struct statx stx;
+#endif
+    struct stat sb;
+    int error;
+    BYTE* body;
+    size_t length;
+
+    // when job was created (in nanoseconds)
+    long long began;
+
+    // next job in queue (of pending or of completed jobs)
+    struct job* next;
+};
+
+// a status code's Status-Line and error page, rendered once (at startup), along
+// with their lengths
+struct status
+{
+    char* line;
+    size_t length;
+    char* page;
+    size_t size;
+};
+
+// a range of a representation's bytes, from first to last, inclusive
+// https://tools.ietf.org/html/rfc7233#section-2.1
+struct range
+{
+    off_t first;
+    off_t last;
+};
+
+// a chunk of memory from which a connection allocates, by bumping offset, whatever
+// lasts only as long as its current request, all of which is reclaimed at once
+// thereafter, along with next chunk (if request outgrew this one)
+struct arena
+{
+    size_t size;
+    size_t offset;
+    struct arena* next;
+    _Alignas(max_align_t) BYTE bytes[];
+};
+
+// a header field in an HTTP/2 connection's table (per HPACK), as offset in table's
+// ring of bytes at which its name begins, followed by its value, and their lengths
+// https://tools.ietf.org/html/rfc7541#section-2.3.2
+struct field
+{
+    size_t offset;
+    size_t name;
+    size_t value;
+};
+
+// what an HTTP/2 connection has beyond what an HTTP/1.1 connection has, its requests
+// and responses being those of its streams, each a connection of its own
+// https://tools.ietf.org/html/rfc7540
+struct session
+{
+    // what remains to be received of client's connection preface
+    const char* preface;
+
+    // bytes read but not yet handled as frames, and their length
+    BYTE input[(9 + FRAME) * 2];
+    size_t length;
+
+    // header block gathered thus far (from a HEADERS frame and any CONTINUATIONs),
+    // its length, stream that it's to open, and that stream, if its block is to
+    // continue (else 0)
+    BYTE block[BUFFER];
+    size_t gathered;
+    unsigned int opening;
+    unsigned int continuing;
+
+    // client's table of header fields (per HPACK), whereby it compresses requests'
+    // headers, as a ring of fields (from index of oldest) and a ring of their bytes,
+    // along with number of fields and table's size and maximum size
+    struct field fields[TABLE / 32];
+    size_t oldest;
+    size_t nfields;
+    BYTE bytes[TABLE];
+    size_t size;
+    size_t limit;
+
+    // streams open (in order of opening), their number, and highest stream
+    // identifier yet seen
+    struct connection* streams;
+    int nstreams;
+    unsigned int highest;
+
+    // connection's window, streams' initial window (per client's settings), and
+    // whether connection is handling frames (and so will write its own once done)
+    long window;
+    long initial;
+    bool handling;
+
+    // whether client (or server) has gone away, whereafter no more streams are opened
+    bool going;
+};
+
+// a client's (non-blocking) connection
+struct connection
+{
+    // kind of descriptor (i.e., CLIENT)
+    enum kind kind;
+
+    // client's socket, and its TLS connection, if server's serving HTTPS
+    int fd;
+    SSL* ssl;
+
+    // connection's state
+    enum state state;
+
+    // buffer (of BUFFER bytes) into which request is read, number of bytes therein,
+    // and request's headers as parsed thus far, after which bytes may be pipelined
+    char* message;
+    size_t length;
+    struct headers parsed;
+
+    // number of requests served thus far and whether connection
+    // is to persist after current one's response
+    int requests;
+    bool keepalive;
+
+    // response thus far, its length, number of bytes thereof already written, and
+    // buffer's capacity (which persists, unless large, from response to response)
+    BYTE* response;
+    size_t size;
+    size_t sent;
+    size_t capacity;
+
+    // arena (if any) from which memory for current request is allocated
+    struct arena* arena;
+
+    // content-codings (as a bitmask) that client accepts, per Accept-Encoding
+    unsigned int accepts;
+
+    // cached entry (if any) whose body, in whichever coding is being sent,
+    // is to follow response, along with that coding and what's to be sent of
+    // that body (e.g., just a range thereof) and its length
+    struct entry* entry;
+    enum coding coding;
+    const BYTE* body;
+    size_t extent;
+
+    // file (if any) whose content is to follow response, sent straight from
+    // page cache, along with offset at which to resume and bytes remaining
+    int file;
+    off_t offset;
+    off_t remaining;
+
+    // ranges (if any) of entry's body or of file to be sent in a 206 response
+    // (as parts of a multipart/byteranges one, if more than one), their number,
+    // index of next part, and full representation's length and MIME type
+    struct range* ranges;
+    int parts;
+    int part;
+    off_t total;
+    const char* type;
+
+    // backend (if any) to which request has been relayed
+    struct backend* backend;
+
+    // job (if any) for which connection is waiting
+    struct job* job;
+
+    // HTTP/2 state, if connection has become an HTTP/2 connection, else, if connection
+    // is one of such a connection's streams (whose socket is that connection's), that
+    // connection, stream's identifier, window, and urgency, whether its response's
+    // headers and end have been framed (or stream's been reset), and next stream
+    struct session* session;
+    struct connection* parent;
+    unsigned int id;
+    long window;
+    int urgency;
+    bool headed;
+    bool ended;
+    struct connection* sibling;
+
+    // when (in nanoseconds) current request began to be parsed, when its response
+    // began to be written (0 until then), and how long it's spent in each stage
+    long long began;
+    long long writing;
+    long long spans[STAGES];
+
+    // client's address (as text), and response's status code and number of bytes
+    // thereof written thus far, for access log
+    char address[INET6_ADDRSTRLEN];
+    int code;
+    unsigned long long written;
+
+    // when (in milliseconds) connection is to be closed unless it progresses further
+    // (0 if never), and its neighbors in its slot of timer wheel
+    long deadline;
+    struct connection* earlier;
+    struct connection* later;
+
+    // next connection to be freed (or kept as a spare), once closed
+    struct connection* next;
+};
+
+// a (non-blocking) connection to a FastCGI backend (e.g., php-fpm or php-cgi)
+struct backend
+{
+    // kind of descriptor (i.e., BACKEND)
+    enum kind kind;
+
+    // backend's socket
+    int fd;
+
+    // client whose request backend is processing, if any, and when (in nanoseconds)
+    // backend was handed request
+    struct connection* client;
+    long long began;
+
+    // records of request, their length, and number of bytes thereof
+    // already written
+    BYTE* request;
+    size_t size;
+    size_t sent;
+
+    // bytes read but not yet parsed into records, and their length
+    BYTE* input;
+    size_t length;
+
+    // response (i.e., content of FCGI_STDOUT records) buffered thus far, and its
+    // length, until response is streamed to client (in chunks) as it's produced
+    BYTE* output;
+    size_t produced;
+    bool streaming;
+
+    // whether backend has served a request before (and so might've been
+    // closed by peer since), and whether any of response has been read
+    bool reused;
+    bool responded;
+
+    // next backend in pool of idle ones, or to be freed once closed
+    struct backend* next;
+};
+
+// an address on which server listens (as given to -l), and its socket (in a worker,
+// that worker's own), plus path of its unix socket (if any and if bound by this process)
+// to be removed once server stops
+struct endpoint
+{
+    // kind of descriptor (i.e., LISTENER)
+    enum kind kind;
+
+    // address (e.g., *:8080, [::1]:8080, or unix:/path/to/socket) and socket
+    const char* address;
+    int fd;
+    const char* path;
+};
+
+// a process's metrics, in memory shared by all workers, each of which is the only
+// writer of its own (so needn't lock), whereby any can report all; fields are all
+// counters (or gauges) of the same type so that processes' can be summed word by word
+struct metrics
+{
+    // responses sent, by status code, and bytes sent
+    unsigned long long responses[600];
+    unsigned long long sent;
+
+    // connections open, refused (for want of room), and timed out
+    unsigned long long connections;
+    unsigned long long refused;
+    unsigned long long expired;
+
+    // hits and misses of cache of files (and listings) and of cache of paths' resolutions
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long routed;
+    unsigned long long unrouted;
+
+    // histograms of each stage's latencies, along with sums thereof (in nanoseconds)
+    unsigned long long latencies[STAGES][BUCKETS];
+    unsigned long long sums[STAGES];
+
+    // notes dropped from access log, for want of room in ring
+    unsigned long long dropped;
+};
+
+// a client's address and its number of connections open
+struct peer
+{
+    char address[INET6_ADDRSTRLEN];
+    int connections;
+};
+
+// a request's entry in access log, as jotted (but not yet formatted) by event loop
+// for a thread to format and write later: client's address, when response was sent,
+// its status code and bytes (headers included, as with Apache's %O), how long request
+// took (in nanoseconds), and request-line, Referer, and User-Agent (each truncated,
+// if need be), plus, for tracing, how long it spent in each stage and IDs (in hex)
+// of its trace, its span, and its parent span (if any)
+struct note
+{
+    char address[INET6_ADDRSTRLEN];
+    time_t time;
+    int code;
+    unsigned long long bytes;
+    long long duration;
+    long long spans[STAGES];
+    char trace[33];
+    char span[17];
+    char parent[17];
+    char request[BYTES / 2];
+    char referer[BYTES / 4];
+    char agent[BYTES / 4];
+};
+
 // prototypes
-bool connected(void);
+bool abandon(struct connection* c, unsigned int code);
+struct backend* acquire(void);
+bool admit(const char* address);
+unsigned int adopt(struct connection* c, const BYTE* payload, size_t length);
+void advance(struct connection* c);
+void* allot(struct connection* c, size_t n);
+bool append(char** buffer, size_t* length, size_t* capacity, const char* s, size_t n);
+bool bequeath(void);
+struct connection* branch(struct connection* c, unsigned int id);
+bool bundle(void);
+struct entry* cache(const char* path, const struct stat* sb, const char* type, BYTE* body, size_t length);
+struct entry* cached(const char* path);
+bool chunk(struct connection* c, const BYTE* data, size_t length);
+int choose(SSL* ssl, const unsigned char** out, unsigned char* outlen, const unsigned char* in, unsigned int inlen,
+    void* arg);
+void clip(char* buffer, size_t size, const char* s, size_t n);
+bool commence(struct connection* c);
+bool collect(void);
+void complete(void);
+void conclude(struct backend* b, bool ok);
+bool compressible(const char* type);
+struct connection* connected(struct endpoint* e);
+int delimit(char* buffer, size_t size, const struct connection* c, int part);
+bool deliver(struct entry* e);
+void detach(struct backend* b, bool reusable);
+bool dial(struct backend* b);
+void dismiss(const char* address);
+void drain(void);
+size_t emit(BYTE* p, int first, int n, size_t value);
+bool encode(struct entry* e, enum coding coding);
 void error(unsigned short code);
+size_t escape(char* buffer, const char* s, bool json);
+void evict(struct entry* e);
+bool excerpt(struct connection* c);
+int expire(void);
+bool extend(const char* path);
+void fail(struct backend* b);
+const char* find(const char* s, size_t n, char c);
+bool flush(struct connection* c);
+void forget(struct route* r);
+bool forward(struct connection* c);
+bool frame(struct connection* c);
 void freedir(struct dirent** namelist, int n);
+bool freeze(const char* directory);
+bool fresh(const char* etag, time_t mtime);
+bool grow(struct connection* c, size_t n);
 void handler(int signal);
-char* htmlspecialchars(const char* s);
+void hangup(struct connection* c);
+unsigned long hash(const char* s);
+const char* header(const struct connection* c, const char* name, size_t* length);
+size_t htmlspecialchars(const char* s, size_t n, char* t);
+long huffman(const unsigned char* s, size_t n, char* t, size_t size);
+void identify(struct note* note, const char* value, size_t n);
 char* indexes(const char* path);
+int inherit(const char* address, bool announce);
+bool integer(const unsigned char** p, const unsigned char* end, int n, size_t* value);
 void interpret(const char* path, const char* query);
+void invalidate(void);
+void jot(struct connection* c, long long duration);
+int label(char* buffer, size_t size, const char* type, enum coding coding, const struct stat* sb);
+bool launch(void);
 void list(const char* path);
-bool load(FILE* file, BYTE** content, size_t* length);
+int listener(const char* address, bool shared, bool announce);
+long literal(const unsigned char** p, const unsigned char* end, char* t, size_t size);
+BYTE* load(int file, size_t length);
+struct route* locate(const char* path);
 const char* lookup(const char* path);
-bool parse(const char* line, char* path, char* query);
+void measure(struct connection* c, enum stage stage, long long nanoseconds);
+void multiplex(struct connection* c);
+long long nanotime(void);
+unsigned int negotiate(const char* value, size_t n);
+bool notify(struct connection* c, int type, unsigned int id, unsigned int value);
+long now(void);
+bool observe(const char* path);
+bool offload(void);
+size_t pack(const BYTE* headers, size_t n, BYTE* block);
+size_t pair(BYTE* p, const char* name, size_t m, const char* value, size_t n);
+bool parse(const struct connection* c, char* path, char* query);
+int partition(off_t length, const char* etag, time_t mtime, struct range** ranges);
+void perform(struct job* j);
+bool post(struct connection* c, int type, int flags, unsigned int id, const BYTE* payload, size_t length);
+bool prepare(void);
+bool preserve(const char* path);
+int prioritize(const char* value, size_t n, int urgency);
+ssize_t pull(struct connection* c, void* buffer, size_t n);
+void purge(const char* prefix);
+ssize_t push(struct connection* c, const struct iovec* iov, int iovcnt, int flags);
+void quiesce(void);
+int ready(void** data, int max, int timeout);
 const char* reason(unsigned short code);
+bool recall(const struct session* s, size_t index, char* field, size_t* names, size_t* values);
+bool receive(struct connection* c, int type, int flags, unsigned int id, const BYTE* payload, size_t length);
+void reclaim(struct connection* c);
+bool record(struct backend* b, int type, const BYTE* content, size_t length);
+struct connection* recruit(void);
 void redirect(const char* uri);
-bool request(char** message, size_t* length);
-void respond(int code, const char* headers, const char* body, size_t length);
-void start(short port, const char* path);
+void relay(struct backend* b);
+void release(struct entry* e);
+bool reload(void);
+void remember(struct session* s, const char* field, size_t names, size_t values);
+bool render(void);
+bool reply(const BYTE* output, size_t length, bool chunked);
+int represent(const char* headers, const char* type, off_t length, const char* etag, time_t mtime);
+bool request(struct connection* c);
+struct route* resolve(const char* path);
+bool respond(int code, const char* headers, const char* body, size_t length);
+void restamp(void);
+void resume(struct job* j);
+void retire(struct connection* c);
+const char* scan(const char* s, size_t n, const char* set);
+void scrape(void);
+void* scribe(void* arg);
+bool secure(const char* certificate, const char* key);
+void serve(const struct connection* c);
+void ship(const char* path, const char* type, int file, const struct stat* sb);
+void shrink(struct session* s, size_t size);
+int sibling(const char* path, enum coding coding, struct stat* sb);
+bool spawn(int worker, bool pin);
+bool specific(const char* name, size_t n);
+const BYTE* split(const BYTE* output, size_t length);
+void start(const char* path, int n, bool pin);
 void stop(void);
+bool stream(struct backend* b);
+bool submit(struct job* j);
+void succeed(void);
+void supervise(bool pin);
+int tag(char* buffer, size_t size, const struct stat* sb, enum coding coding);
+void tally(unsigned long long* counter, long long n);
+void thaw(void);
+void timeout(struct connection* c, int seconds);
 void transfer(const char* path, const char* type);
-char* urldecode(const char* s);
+ssize_t translate(struct connection* c, int result);
+bool transmit(struct connection* c);
+bool traverses(const char* path, size_t n);
+int unpack(struct session* s, const unsigned char* block, size_t n, char* message, size_t* length, int* urgency);
+void unroute(const char* path, bool beneath);
+bool upgrade(struct connection* c, bool asked);
+size_t urldecode(const char* s, size_t n, char* t);
+bool watch(int fd, void* data);
+time_t when(const char* value, size_t n);
+void* work(void* arg);
 
 // server's root
 char* root = NULL;
 
-// file descriptor for sockets
-int cfd = -1, sfd = -1;
-
-// flag indicating whether control-c has been heard
+// connection whose request is being served
+struct connection* client = NULL;
+
+// connections closed during current iteration of event loop, to be freed (or kept
+// as spares) thereafter
+struct connection* closed = NULL;
+
+// spare connections and arenas, kept for reuse, along with numbers thereof
+struct connection* spares = NULL;
+int nspares = 0;
+struct arena* arenas = NULL;
+int narenas = 0;
+
+// cache of files in memory, its budget and bytes thereof used, its buckets,
+// and its entries from most recently used to least recently used
+size_t budget = CacheSize * 1024 * 1024;
+size_t used = 0;
+struct entry** buckets = NULL;
+size_t nbuckets = 0;
+size_t entries = 0;
+struct entry* hottest = NULL;
+struct entry* coldest = NULL;
+
+// cache of paths' resolutions, its buckets (allocated once needed), and its
+// number of routes
+struct route** routes = NULL;
+size_t routed = 0;
+
+// whether root's immutable, whereupon it's snapshotted at start, and whether it's
+// been snapshotted (i.e., frozen), along with snapshot's routes (one per path
+// beneath root), their buckets, and their number, plus mapping into which its
+// entries are bundled and that mapping's size
+bool immutable = false;
+bool frozen = false;
+struct route** snapshot = NULL;
+size_t nsnapshot = 0;
+size_t snapshotted = 0;
+BYTE* bundled = NULL;
+size_t nbundled = 0;
+
+// content-codings' names, as in Accept-Encoding and Content-Encoding, and suffixes
+// of files' precompressed siblings (e.g., foo.js.br) encoded therein
+const char* codings[CODINGS] = {"identity", "gzip", "br"};
+const char* suffixes[CODINGS] = {"", ".gz", ".br"};
+
+// stages' names, as in metrics' labels
+const char* stages[STAGES] = {"parse", "resolve", "io", "php", "write", "request"};
+
+// each process's metrics (in memory shared by all workers), their number, and this
+// process's own (a private copy until shared memory is mapped)
+struct metrics* meters = NULL;
+int nmeters = 0;
+struct metrics unmapped;
+struct metrics* meter = &unmapped;
+
+// access log (if any), whether it's in JSON (else in Apache's Combined Log Format),
+// and of how many requests to log only one, along with how many have gone unlogged
+// since last one logged
+int lfd = -1;
+bool json = false;
+int sampling = 1;
+int sampled = 0;
+
+// ring of notes for access log (allocated once needed), number of notes jotted
+// therein by event loop, number thereof written by a thread, and lock whereby that
+// thread and stop() take turns writing
+struct note* notes = NULL;
+unsigned long jotted = 0;
+unsigned long scribed = 0;
+pthread_mutex_t logging = PTHREAD_MUTEX_INITIALIZER;
+
+// Status-Lines and error pages of status codes with reason phrases, by code
+struct status statuses[600];
+
+// Date and Server headers, as of when last restamped (once per second at most),
+// along with their length and when they were restamped
+char stamp[BYTES / 4] = "";
+size_t stamped = 0;
+time_t dated = -1;
+
+// HPACK's static table of header fields, indexed from 1
+// https://tools.ietf.org/html/rfc7541#appendix-A
+const char* statics[][2] =
+{
+    {"", ""}, {":authority", ""}, {":method", "GET"}, {":method", "POST"}, {":path", "/"},
+    {":path", "/index.html"}, {":scheme", "http"}, {":scheme", "https"}, {":status", "200"},
+    {":status", "204"}, {":status", "206"}, {":status", "304"}, {":status", "400"},
+    {":status", "404"}, {":status", "500"}, {"accept-charset", ""}, {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""}, {"accept-ranges", ""}, {"accept", ""}, {"access-control-allow-origin", ""},
+    {"age", ""}, {"allow", ""}, {"authorization", ""}, {"cache-control", ""}, {"content-disposition", ""},
+    {"content-encoding", ""}, {"content-language", ""}, {"content-length", ""}, {"content-location", ""},
+    {"content-range", ""}, {"content-type", ""}, {"cookie", ""}, {"date", ""}, {"etag", ""},
+    {"expect", ""}, {"expires", ""}, {"from", ""}, {"host", ""}, {"if-match", ""},
+    {"if-modified-since", ""}, {"if-none-match", ""}, {"if-range", ""}, {"if-unmodified-since", ""},
+    {"last-modified", ""}, {"link", ""}, {"location", ""}, {"max-forwards", ""},
+    {"proxy-authenticate", ""}, {"proxy-authorization", ""}, {"range", ""}, {"referer", ""},
+    {"refresh", ""}, {"retry-after", ""}, {"server", ""}, {"set-cookie", ""},
+    {"strict-transport-security", ""}, {"transfer-encoding", ""}, {"user-agent", ""}, {"vary", ""},
+    {"via", ""}, {"www-authenticate", ""}
+};
+
+// widths (i.e., lengths in bits) of HPACK's Huffman codes for each byte, and for EOS,
+// whose codes are canonical, so that codes themselves derive from widths alone
+// https://tools.ietf.org/html/rfc7541#appendix-B
+const unsigned char widths[257] =
+{
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30
+};
+
+// boundary between parts of multipart/byteranges responses, chosen once needed
+char boundary[BYTES / 16] = "";
+
+// file of MIME types to load at startup (and upon reload), if any, and types loaded
+// therefrom, which take precedence over built-in ones, hashed by extension into a
+// table (of capacity slots) with open addressing
+const char* mimetypes = NULL;
+char** extensions = NULL;
+char** types = NULL;
+size_t slots = 0;
+size_t loaded = 0;
+
+// inotify instance that watches directories of cached files (and their
+// ancestors) for changes, along with each watch's descriptor and directory
+int ifd = -1;
+int* wds = NULL;
+char** directories = NULL;
+size_t watches = 0;
+
+// path to FastCGI backend's socket (and php-cgi pool listening thereon, if launched
+// by server itself), along with pool of idle connections thereto and any closed
+// during current iteration of event loop, to be freed thereafter
+char* fastcgi = NULL;
+pid_t php = 0;
+struct backend* pool = NULL;
+int pooled = 0;
+struct backend* discarded = NULL;
+
+// io_uring (if set up) via which jobs are performed, along with its rings' heads,
+// tails, masks, and entries, and number of jobs in flight therein
+int ufd = -1;
+unsigned int* sqhead = NULL;
+unsigned int* sqtail = NULL;
+unsigned int* sqmask = NULL;
+unsigned int* sqarray = NULL;
+struct io_uring_sqe* sqes = NULL;
+unsigned int* cqhead = NULL;
+unsigned int* cqtail = NULL;
+unsigned int* cqmask = NULL;
+struct io_uring_cqe* cqes = NULL;
+unsigned int flying = 0;
+
+// else threads by which jobs are performed, along with queues of pending jobs
+// (oldest first, through latest) and of completed jobs (both guarded by lock),
+// and whether any threads are running
+pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t queued = PTHREAD_COND_INITIALIZER;
+struct job* pending = NULL;
+struct job* latest = NULL;
+struct job* completed = NULL;
+bool threads = false;
+
+// descriptors via which jobs' completions are reported to event loop (an eventfd,
+// to which io_uring too reports, on Linux, else a pipe), -1 if jobs are synchronous
+int nfd[2] = {-1, -1};
+
+// timer wheel of connections with deadlines, each slot holding those due within its
+// TICK milliseconds, along with number of slot (since clock's epoch) through which
+// wheel has been turned and number of connections thereon
+struct connection* wheel[SLOTS];
+long ticked = 0;
+int timed = 0;
+
+// limits on connections open at once, per worker and per client's address (0 if none)
+int capacity = WorkerConnections;
+int quota = LimitConnPerAddress;
+
+// table of clients' addresses, with open addressing, with which connections are counted
+// per address, and its number of slots (twice as many as connections, so that table
+// stays sparse)
+struct peer* peers = NULL;
+size_t npeers = 0;
+
+// file descriptor for event loop, and number of connections it's watching
+int efd = -1;
+int connections = 0;
+
+// addresses on which server listens, and their number
+struct endpoint* endpoints = NULL;
+int nendpoints = 0;
+
+// TLS context (with certificate, key, and keys for session tickets), if serving HTTPS,
+// and files whence certificate and key are loaded (and reloaded)
+SSL_CTX* tls = NULL;
+const char* certificate = NULL;
+const char* key = NULL;
+
+// worker processes, if any, along with their sockets (nendpoints per worker), which
+// remain open in parent so that clients queue for a worker even while it's respawned
+pid_t* pids = NULL;
+int* sockets = NULL;
+int workers = 0;
+
+// server's command-line arguments, with which it executes its successor when upgraded
+char** arguments = NULL;
+
+// sockets handed down by predecessor (if server's upgrading one), their number, and
+// socket via which they were, whereon predecessor's to be told once they're in use
+struct endpoint* inherited = NULL;
+int ninherited = 0;
+int ancestor = -1;
+
+// flags indicating whether control-c has been heard, whether server's to stop once
+// its connections are done (upon SIGQUIT, or once succeeded by an upgrade), and
+// whether it's to reload (upon SIGHUP) or to be upgraded (upon SIGUSR2)
 bool signaled = false;
+bool quitting = false;
+bool reloading = false;
+bool upgrading = false;
 
+// main is omitted when this file is included by a harness (e.g., microbench.c)
+// that calls its functions directly
+#ifndef HARNESS
 int main(int argc, char* argv[])
 {
     // a global variable defined in errno.h that's "set by system 
@@ -76,32 +1126,120 @@ int main(int argc, char* argv[])
     // in the event of an error to indicate what went wrong"
     errno = 0;
 
-    // default to port 8080
-    int port = 8080;
+    // remember arguments, with which to execute successor, if upgraded
+    arguments = argv;
+
+    // addresses on which to listen (at most one per argument)
+    endpoints = calloc(argc + 1, sizeof(struct endpoint));
+    if (endpoints == NULL)
+    {
+        return 1;
+    }
+
+    // default to serving from a single process
+    int n = 0;
+    bool pin = false;
+
+    // default to no access log
+    const char* log = NULL;
 
     // usage
-    const char* usage = "Usage: server [-p port] /path/to/root";
+    const char* usage = "Usage: server [-a log [-j] [-s n]] [-C certificate.pem [-K key.pem]] [-f socket] [-l address]... "
+        "[-m megabytes] [-N connections] [-n connections] [-p port] [-S] [-t mime.types] [-w workers [-c]] /path/to/root";
 
     // parse command-line arguments
     int opt;
-    while ((opt = getopt(argc, argv, "hp:")) != -1)
+    while ((opt = getopt(argc, argv, "a:C:cf:hjK:l:m:N:n:p:Ss:t:w:")) != -1)
     {
         switch (opt)
         {
+            // -a log
+            case 'a':
+                log = optarg;
+                break;
+
+            // -C certificate.pem
+            case 'C':
+                certificate = optarg;
+                break;
+
+            // -c
+            case 'c':
+                pin = true;
+                break;
+
+            // -f socket
+            case 'f':
+                fastcgi = optarg;
+                break;
+
             // -h
             case 'h':
                 printf("%s\n", usage);
                 return 0;
 
-            // -p port
+            // -j
+            case 'j':
+                json = true;
+                break;
+
+            // -K key.pem
+            case 'K':
+                key = optarg;
+                break;
+
+            // -l address (e.g., 127.0.0.1:8080, [::1]:8080, or unix:/path/to/socket),
+            // or -p port, i.e., *:port
+            case 'l':
             case 'p':
-                port = atoi(optarg);
+                endpoints[nendpoints++].address = optarg;
+                break;
+
+            // -m megabytes
+            case 'm':
+                budget = (size_t) atoi(optarg) * 1024 * 1024;
+                break;
+
+            // -N connections (per client's address, or 0 for no limit)
+            case 'N':
+                quota = atoi(optarg);
+                break;
+
+            // -n connections (per worker)
+            case 'n':
+                capacity = atoi(optarg);
+                break;
+
+            // -S
+            case 'S':
+                immutable = true;
+                break;
+
+            // -s n
+            case 's':
+                sampling = atoi(optarg);
+                break;
+
+            // -t mime.types
+            case 't':
+                mimetypes = optarg;
+                break;
+
+            // -w workers
+            case 'w':
+                n = atoi(optarg);
+                if (n == 0)
+                {
+                    // one worker per online CPU
+                    n = sysconf(_SC_NPROCESSORS_ONLN);
+                }
                 break;
         }
     }
 
-    // ensure port is a non-negative short and path to server's root is specified
-    if (port < 0 || port > SHRT_MAX || argv[optind] == NULL || strlen(argv[optind]) == 0)
+    // ensure workers and quota aren't negative, capacity and sampling are positive,
+    // and path to server's root is specified
+    if (n < 0 || quota < 0 || capacity < 1 || sampling < 1 || argv[optind] == NULL || strlen(argv[optind]) == 0)
     {
         // announce usage
         printf("%s\n", usage);
@@ -110,1084 +1248,8014 @@ int main(int argc, char* argv[])
         return 2;
     }
 
-    // start server
-    start(port, argv[optind]);
+    // listen on port 8080 (on all addresses) unless told otherwise
+    if (nendpoints == 0)
+    {
+        endpoints[nendpoints++].address = "8080";
+    }
+    for (int i = 0; i < nendpoints; i++)
+    {
+        endpoints[i].kind = LISTENER;
+        endpoints[i].fd = -1;
+    }
 
-    // listen for SIGINT (aka control-c)
+    // listen for SIGINT (aka control-c), SIGQUIT, SIGHUP, and SIGUSR2
     struct sigaction act;
     act.sa_handler = handler;
     act.sa_flags = 0;
     sigemptyset(&act.sa_mask);
     sigaction(SIGINT, &act, NULL);
+    sigaction(SIGQUIT, &act, NULL);
+    sigaction(SIGHUP, &act, NULL);
+    sigaction(SIGUSR2, &act, NULL);
 
-    // a message and its length
-    char* message = NULL;
-    size_t length = 0;
+    // collect sockets handed down by predecessor, if upgrading one
+    if (!collect())
+    {
+        stop();
+    }
 
-    // path requested
-    char* path = NULL;
+    // load MIME types, if specified, before any workers are spawned
+    if (mimetypes != NULL && !extend(mimetypes))
+    {
+        stop();
+    }
 
-    // accept connections one at a time
-    while (true)
+    // open access log (or use stdout, if log is -), if specified, before any workers
+    // are spawned, so that all append to it
+    if (log != NULL)
     {
-        // free last path, if any
-        if (path != NULL)
+        lfd = (strcmp(log, "-") == 0) ? STDOUT_FILENO : open(log, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (lfd == -1)
         {
-            free(path);
-            path = NULL;
+            stop();
         }
+    }
 
-        // free last message, if any
-        if (message != NULL)
-        {
-            free(message);
-            message = NULL;
-        }
-        length = 0;
+    // prepare to serve HTTPS, if a certificate's specified, before any workers are
+    // spawned, so that all can resume sessions begun with others
+    key = (key != NULL) ? key : certificate;
+    if (certificate != NULL && !secure(certificate, key))
+    {
+        stop();
+    }
 
-        // close last client's socket, if any
-        if (cfd != -1)
-        {
-            close(cfd);
-            cfd = -1;
-        }
+    // start server, returning only in process that's to serve connections
+    start(argv[optind], n, pin);
 
+    // ignore SIGPIPE, so that writes to sockets closed by clients merely fail
+    struct sigaction ign;
+    ign.sa_handler = SIG_IGN;
+    ign.sa_flags = 0;
+    sigemptyset(&ign.sa_mask);
+    sigaction(SIGPIPE, &ign, NULL);
+
+    // serve connections as they become ready, without blocking on any one of them
+    while (true)
+    {
         // check for control-c
         if (signaled)
         {
             stop();
         }
 
-        // check whether client has connected
-        if (connected())
+        // upon SIGHUP or SIGUSR2 (which, with no workers to spawn anew, are one and
+        // the same), hand server's sockets down to a successor, then quiesce, stopping
+        // once connections are done
+        if ((reloading || upgrading) && !quitting)
         {
-            // check for request
-            if (request(&message, &length))
-            {
-                // extract message's request-line
-                // http://www.w3.org/Protocols/rfc2616/rfc2616-sec5.html
-                const char* haystack = message;
-                const char* needle = strstr(haystack, "\r\n");
-                if (needle == NULL)
-                {
-                    error(500);
-                    continue;
-                }
-                char line[needle - haystack + 2 + 1];
-                strncpy(line, haystack, needle - haystack + 2);
-                line[needle - haystack + 2] = '\0';
-
-                // log request-line
-                printf("%s", line);
-
-                // parse request-line
-                    char abs_path[LimitRequestLine + 1];
-                    char query[LimitRequestLine + 1];
-                if (parse(line, abs_path, query))
-                {
-                    // URL-decode absolute-path
-                    char* p = urldecode(abs_path);
-                    if (p == NULL)
-                    {
-                        error(500);
-                        continue;
-                    }
-
-                    // resolve absolute-path to local path
-                    path = malloc(strlen(root) + strlen(p) + 1);
-                    if (path == NULL)
-                    {
-                        error(500);
-                        continue;
-                    }
-                    strcpy(path, root);
-                    strcat(path, p);
-                    free(p);
-
-                    // ensure path exists
-                    if (access(path, F_OK) == -1)
-                    {
-                        error(404);
-                        continue;
-                    }
+            quitting = bequeath();
+        }
+        reloading = upgrading = false;
+        if (quitting)
+        {
+            quiesce();
+        }
 
-                    // if path to directory
-                    struct stat sb;
-                    if (stat(path, &sb) == 0 && S_ISDIR(sb.st_mode))
-                    {
-                        // redirect from absolute-path to absolute-path/
-                        if (abs_path[strlen(abs_path) - 1] != '/')
-                        {
-                            char uri[strlen(abs_path) + 1 + 1];
-                            strcpy(uri, abs_path);
-                            strcat(uri, "/");
-                            redirect(uri);
-                            continue;
-                        }
+        // close connections that have passed their deadlines, then wait for sockets
+        // to become ready (or for next slot of deadlines to come due)
+        void* data[EVENTS];
+        int n = ready(data, EVENTS, expire());
 
-                        // use path/index.php or path/index.html, if present, instead of directory's path
-                        char* index = indexes(path);
-                        if (index != NULL)
-                        {
-                            free(path);
-                            path = index;
-                        }
+        // date responses to follow
+        restamp();
+        for (int i = 0; i < n; i++)
+        {
+            // invalidate cached entries whose files have changed
+            if (data[i] == &ifd)
+            {
+                invalidate();
+            }
 
-                        // list contents of directory
-                        else
-                        {
-                            list(path);
-                            continue;
-                        }
-                    }
+            // resume clients whose jobs have completed
+            else if (data[i] == nfd)
+            {
+                complete();
+            }
 
-                    // look up MIME type for file at path
-                    const char* type = lookup(path);
-                    if (type == NULL)
-                    {
-                        error(501);
-                        continue;
-                    }
+            // accept as many clients as have connected to one of server's sockets
+            else if (*(enum kind*) data[i] == LISTENER)
+            {
+                struct connection* c;
+                while ((c = connected(data[i])) != NULL)
+                {
+                    // client may have sent its request already
+                    advance(c);
+                }
+            }
 
-                    // interpret PHP script at path
-                    if (strcasecmp("text/x-php", type) == 0)
-                    {
-                        interpret(path, query);
-                    }
+            // relay request to backend and response to client as far as each can go
+            else if (*(enum kind*) data[i] == BACKEND)
+            {
+                relay(data[i]);
+            }
 
-                    // transfer file at path
-                    else
-                    {
-                        transfer(path, type);
-                    }
-                }
+            // advance client's connection as far as it can go
+            else
+            {
+                advance(data[i]);
             }
         }
+
+        // retire connections closed during this iteration
+        while (closed != NULL)
+        {
+            struct connection* next = closed->next;
+            retire(closed);
+            closed = next;
+        }
+        while (discarded != NULL)
+        {
+            struct backend* next = discarded->next;
+            free(discarded);
+            discarded = next;
+        }
     }
 }
+#endif
 
 /**
- * Checks (without blocking) whether a client has connected to server. 
- * Returns true iff so.
+ * Queues GOAWAY for HTTP/2 connection's client, with error code, whereafter connection
+ * is to be closed. Returns false, for callers' convenience.
+ * https://tools.ietf.org/html/rfc7540#section-6.8
  */
-bool connected(void)
+bool abandon(struct connection* c, unsigned int code)
 {
-    struct sockaddr_in cli_addr;
-    memset(&cli_addr, 0, sizeof(cli_addr));
-    socklen_t cli_len = sizeof(cli_addr);
-    cfd = accept(sfd, (struct sockaddr*) &cli_addr, &cli_len);
-    if (cfd == -1)
-    {
-        return false;
-    }
-    return true;
+    struct session* s = c->session;
+    BYTE payload[8] = {(s->highest >> 24) & 0x7f, s->highest >> 16, s->highest >> 8, s->highest,
+        code >> 24, code >> 16, code >> 8, code};
+    post(c, HTTP2_GOAWAY, 0, 0, payload, sizeof(payload));
+    s->going = true;
+    return false;
 }
 
 /**
- * Responds to client with specified status code.
+ * Connects (without blocking) to FastCGI backend, reusing an idle connection
+ * from pool, if any. Returns backend, else NULL.
  */
-void error(unsigned short code)
+struct backend* acquire(void)
 {
-    // determine code's reason-phrase
-    const char* phrase = reason(code);
-    if (phrase == NULL)
+    // reuse idle connection
+    if (pool != NULL)
     {
-        return;
+        struct backend* b = pool;
+        pool = b->next;
+        pooled--;
+        b->next = NULL;
+        b->reused = true;
+        return b;
     }
 
-    // template for response's content
-    char* template = "<html><head><title>%i %s</title></head><body><h1>%i %s</h1></body></html>";
-
-    // render template
-    char body[(strlen(template) - 2 - ((int) log10(code) + 1) - 2 + strlen(phrase)) * 2 + 1];
-    int length = sprintf(body, template, code, phrase, code, phrase);
-    if (length < 0)
+    // connect anew
+    struct backend* b = calloc(1, sizeof(struct backend));
+    if (b == NULL)
     {
-        body[0] = '\0';
-        length = 0;
+        return NULL;
     }
-
-    // respond with error
-    char* headers = "Content-Type: text/html\r\n";
-    respond(code, headers, body, length);
+    b->kind = BACKEND;
+    b->fd = -1;
+    if (!dial(b))
+    {
+        free(b);
+        return NULL;
+    }
+    return b;
 }
 
 /**
- * Frees memory allocated by scandir.
+ * Counts another connection from client's address, unless it has quota open already,
+ * admitting clients of unix sockets (e.g., sidecars, all of whose addresses are alike)
+ * uncounted, as all clients are if there's no quota. Returns true iff admitted.
  */
-void freedir(struct dirent** namelist, int n)
+bool admit(const char* address)
 {
-    if (namelist != NULL)
+    if (quota == 0 || strcmp(address, "unix:") == 0)
     {
-        for (int i = 0; i < n; i++)
-        {
-            free(namelist[i]);
-        }
-        free(namelist);
+        return true;
+    }
+    size_t i = hash(address) % npeers;
+    while (peers[i].connections > 0 && strcmp(peers[i].address, address) != 0)
+    {
+        i = (i + 1) % npeers;
+    }
+    if (peers[i].connections >= quota)
+    {
+        return false;
+    }
+    if (peers[i].connections == 0)
+    {
+        strcpy(peers[i].address, address);
     }
+    peers[i].connections++;
+    return true;
 }
- 
+
 /**
- * Handles signals.
+ * Adopts HTTP/2 connection's client's settings, as length bytes of a SETTINGS frame's
+ * payload (or of HTTP2-Settings, decoded), adjusting open streams' windows by any change
+ * to their initial size. Returns error code with which to abandon connection if
+ * settings are invalid, else HTTP2_NO_ERROR.
+ * https://tools.ietf.org/html/rfc7540#section-6.5.2
  */
-void handler(int signal)
+unsigned int adopt(struct connection* c, const BYTE* payload, size_t length)
 {
-    // control-c
-    if (signal == SIGINT)
+    struct session* s = c->session;
+    for (size_t i = 0; i + 6 <= length; i += 6)
     {
-        signaled = true;
+        const unsigned char* p = (const unsigned char*) payload + i;
+        unsigned int id = (p[0] << 8) | p[1];
+        unsigned long value = ((unsigned long) p[2] << 24) | (p[3] << 16) | (p[4] << 8) | p[5];
+        if (id == HTTP2_SETTINGS_ENABLE_PUSH && value > 1)
+        {
+            return HTTP2_PROTOCOL_ERROR;
+        }
+        if (id == HTTP2_SETTINGS_MAX_FRAME_SIZE && (value < FRAME || value > 0xffffff))
+        {
+            return HTTP2_PROTOCOL_ERROR;
+        }
+        if (id == HTTP2_SETTINGS_INITIAL_WINDOW_SIZE)
+        {
+            if (value > 0x7fffffff)
+            {
+                return HTTP2_FLOW_CONTROL_ERROR;
+            }
+            for (struct connection* t = s->streams; t != NULL; t = t->sibling)
+            {
+                t->window += (long) value - s->initial;
+                if (t->window > 0x7fffffff)
+                {
+                    return HTTP2_FLOW_CONTROL_ERROR;
+                }
+            }
+            s->initial = value;
+        }
     }
+    return HTTP2_NO_ERROR;
 }
 
 /**
- * Escapes string for HTML. Returns dynamically allocated memory for escaped
- * string that must be deallocated by caller.
+ * Advances connection through its states, reading each of its requests, dispatching
+ * it, and writing its response, as far as it can go without blocking.
  */
-char* htmlspecialchars(const char* s)
+void advance(struct connection* c)
 {
-    // ensure s is not NULL
-    if (s == NULL)
-    {
-        return NULL;
-    }
-
-    // allocate enough space for an unescaped copy of s
-    char* t = malloc(strlen(s) + 1);
-    if (t == NULL)
+    // let HTTP/2 connections advance their streams instead
+    if (c->session != NULL)
     {
-        return NULL;
+        if (c->fd != -1)
+        {
+            multiplex(c);
+        }
+        return;
     }
-    t[0] = '\0';
 
-    // iterate over characters in s, escaping as needed
-    for (int i = 0, old = strlen(s), new = old; i < old; i++)
+    // ignore connections already closed
+    while (c->fd != -1 && c->state != CLOSING)
     {
-        // escape &
-        if (s[i] == '&')
+        // read request's headers
+        if (c->state == READING)
         {
-            const char* entity = "&amp;";
-            new += strlen(entity);
-            t = realloc(t, new);
-            if (t == NULL)
+            long long t = nanotime();
+            size_t length = c->length;
+            if (!request(c))
             {
-                return NULL;
+                // once request has begun, allow only so long for rest of its headers
+                if (length == 0 && c->length > 0 && c->state == READING)
+                {
+                    timeout(c, RequestReadTimeout);
+                }
+                break;
             }
-            strcat(t, entity);
-        }
 
-        // escape "
-        else if (s[i] == '"')
-        {
-            const char* entity = "&quot;";
-            new += strlen(entity);
-            t = realloc(t, new);
-            if (t == NULL)
+            // switch to HTTP/2 if client's first request is instead HTTP/2's connection
+            // preface, with which clients that know server speaks HTTP/2 begin
+            // https://tools.ietf.org/html/rfc7540#section-3.4
+            if (c->requests == 0 && c->parent == NULL && c->parsed.request.length == strlen("PRI * HTTP/2.0")
+                && strncmp(c->message + c->parsed.request.start, "PRI * HTTP/2.0", strlen("PRI * HTTP/2.0")) == 0)
             {
-                return NULL;
+                if (!upgrade(c, false))
+                {
+                    c->state = CLOSING;
+                    break;
+                }
+                multiplex(c);
+                return;
             }
-            strcat(t, entity);
+            c->began = t;
+            memset(c->spans, 0, sizeof(c->spans));
+            measure(c, PARSE, nanotime() - t);
+            timeout(c, 0);
+            c->state = DISPATCHING;
         }
 
-        // escape '
-        else if (s[i] == '\'')
+        // dispatch request to its handler, which queues a response (or relays
+        // request to a backend), unless request is invalid, in which case
+        // connection is closed
+        if (c->state == DISPATCHING)
         {
-            const char* entity = "&#039;";
-            new += strlen(entity);
-            t = realloc(t, new);
-            if (t == NULL)
+            c->requests++;
+            c->keepalive = (c->requests < MaxKeepAliveRequests) && !quitting;
+
+            // switch to HTTP/2 if client asks, unless request has a body (which
+            // would precede frames) or connection's over TLS (whereon only ALPN
+            // can select HTTP/2), serving request as stream 1
+            // https://tools.ietf.org/html/rfc7540#section-3.2
+            size_t n;
+            const char* value = header(c, "Upgrade", &n);
+            if (c->parsed.invalid == 0 && c->parent == NULL && c->ssl == NULL && value != NULL && n == 3 && strncasecmp(value, "h2c", 3) == 0
+                && header(c, "HTTP2-Settings", &n) != NULL && header(c, "Content-Length", &n) == NULL
+                && header(c, "Transfer-Encoding", &n) == NULL)
             {
-                return NULL;
+                if (!upgrade(c, true))
+                {
+                    c->state = CLOSING;
+                    break;
+                }
+                multiplex(c);
+                return;
+            }
+            client = c;
+            if (c->parsed.invalid != 0)
+            {
+                error(c->parsed.invalid);
+                c->keepalive = false;
+            }
+            else
+            {
+                serve(c);
             }
-            strcat(t, entity);
+            client = NULL;
+            c->state = (c->backend != NULL || c->job != NULL) ? WAITING : WRITING;
         }
 
-        // escape <
-        else if (s[i] == '<')
+        // write whatever of response backend has streamed thus far, then let backend
+        // stream more, until it's done, whereupon it will advance connection
+        if (c->state == WAITING)
         {
-            const char* entity = "&lt;";
-            new += strlen(entity);
-            t = realloc(t, new);
-            if (t == NULL)
+            unsigned long long written = c->written;
+            if (c->backend != NULL && flush(c))
             {
-                return NULL;
+                timeout(c, 0);
+                c->size = 0;
+                c->sent = 0;
+                relay(c->backend);
+                return;
+            }
+
+            // allow client only so long to accept more of response
+            if (c->backend != NULL && c->state == WAITING && (c->written != written || c->deadline == 0))
+            {
+                timeout(c, Timeout);
             }
-            strcat(t, entity);
+            break;
         }
 
-        // escape >
-        else if (s[i] == '>')
+        // write response
+        if (c->state == WRITING)
         {
-            const char* entity = "&gt;";
-            new += strlen(entity);
-            t = realloc(t, new);
-            if (t == NULL)
+            if (c->writing == 0)
             {
-                return NULL;
+                c->writing = nanotime();
+            }
+            unsigned long long written = c->written;
+            if (!flush(c))
+            {
+                // allow client only so long to accept more of response
+                if (c->state == WRITING && (c->written != written || c->deadline == 0))
+                {
+                    timeout(c, Timeout);
+                }
+                break;
+            }
+            long long t = nanotime();
+            measure(c, WRITE, t - c->writing);
+            measure(c, REQUEST, t - c->began);
+            DTRACE_PROBE5(server, request, c->fd, c->code, t - c->began,
+                c->message + c->parsed.request.start, c->parsed.request.length);
+            jot(c, t - c->began);
+            c->writing = 0;
+            c->written = 0;
+
+            // close connection unless it's to persist (as streams never do, once done)
+            if (!c->keepalive || c->parent != NULL)
+            {
+                c->state = CLOSING;
+                break;
+            }
+
+            // discard request, keeping whatever bytes have been pipelined after it
+            c->length -= c->parsed.end;
+            memmove(c->message, c->message + c->parsed.end, c->length);
+            memset(&c->parsed, 0, sizeof(c->parsed));
+
+            // discard response, keeping its buffer unless it grew large
+            if (c->capacity > BUFFER)
+            {
+                free(c->response);
+                c->response = NULL;
+                c->capacity = 0;
+            }
+            c->size = 0;
+            c->sent = 0;
+            if (c->entry != NULL)
+            {
+                release(c->entry);
+                c->entry = NULL;
             }
-            strcat(t, entity);
+            if (c->file != -1)
+            {
+                close(c->file);
+                c->file = -1;
+            }
+            c->ranges = NULL;
+            c->parts = 0;
+
+            // discard memory allotted for request
+            reclaim(c);
+
+            // await next request, allowing only so long for it (or for rest of it,
+            // if some has been pipelined)
+            c->state = READING;
+            timeout(c, (c->length > 0) ? RequestReadTimeout : KeepAliveTimeout);
         }
+    }
+
+    // close connection, unless already closed (e.g., by its backend)
+    if (c->state == CLOSING && c->fd != -1)
+    {
+        hangup(c);
+    }
+}
+
+/**
+ * Allots n bytes (suitably aligned) from connection's arena, acquiring one (or
+ * another, if request has outgrown it) as needed. Memory remains valid until arena
+ * is reclaimed, once request has been answered. Returns memory, else NULL.
+ */
+void* allot(struct connection* c, size_t n)
+{
+    // round n up to alignment of any type
+    n = (n + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
 
-        // don't escape
+    // acquire another arena, if current one (if any) lacks room, reusing a spare
+    // unless n is too large for one
+    if (c->arena == NULL || c->arena->size - c->arena->offset < n)
+    {
+        struct arena* a = NULL;
+        if (n <= ARENA && arenas != NULL)
+        {
+            a = arenas;
+            arenas = a->next;
+            narenas--;
+        }
         else
         {
-            strncat(t, s + i, 1);
+            size_t size = (n > ARENA) ? n : ARENA;
+            a = malloc(sizeof(struct arena) + size);
+            if (a == NULL)
+            {
+                return NULL;
+            }
+            a->size = size;
         }
+        a->offset = 0;
+        a->next = c->arena;
+        c->arena = a;
     }
 
-    // escaped string
-    return t;
+    // bump offset
+    void* p = c->arena->bytes + c->arena->offset;
+    c->arena->offset += n;
+    return p;
 }
 
 /**
- * Checks, in order, whether index.php or index.html exists inside of path.
- * Returns path to first match if so, else NULL.
+ * Appends n bytes from s to buffer, which holds length bytes, doubling its capacity
+ * as needed so that appending is linear overall. Returns true iff successful.
  */
-char* indexes(const char* path)
+bool append(char** buffer, size_t* length, size_t* capacity, const char* s, size_t n)
 {
-	// Allocating memory for indexed path
-    char* indexphp = malloc(strlen(path) + 12 + 1);
-    strcpy(indexphp, path);
-    strcat(indexphp, "/index.php");
-
-    char* indexhtml = malloc(strlen(path) + 13 + 1);
-    strcpy(indexhtml, path);
-    strcat(indexhtml, "/index.html");
-
-    // Ensure Index files exists
-    if (access(indexphp, F_OK) == 0)
-    	return indexphp;
-    else if (access(indexhtml, F_OK) == 0)
-    	return indexhtml;
-    else
-    	return NULL;
+    if (*length + n > *capacity)
+    {
+        size_t m = (*capacity == 0) ? BUFFER : *capacity;
+        while (*length + n > m)
+        {
+            m *= 2;
+        }
+        char* b = realloc(*buffer, m);
+        if (b == NULL)
+        {
+            return false;
+        }
+        *buffer = b;
+        *capacity = m;
+    }
+    memcpy(*buffer + *length, s, n);
+    *length += n;
+    return true;
 }
 
 /**
- * Interprets PHP file at path using query string.
+ * Hands server's sockets down (via SCM_RIGHTS) to a successor, i.e., a newly executed
+ * server (whichever binary is now at argv[0], with the same arguments), waiting until
+ * successor's listening on them, whereupon this process is to quiesce. Returns true
+ * iff successful, else server carries on as though never asked.
  */
-void interpret(const char* path, const char* query)
+bool bequeath(void)
 {
-    // ensure path is readable
-    if (access(path, R_OK) == -1)
+    // create a pair of sockets that preserve messages' boundaries, one for successor
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) == -1)
     {
-        error(403);
-        return;
+        return false;
     }
 
-    // open pipe to PHP interpreter
-    char* format = "QUERY_STRING=\"%s\" REDIRECT_STATUS=200 SCRIPT_FILENAME=\"%s\" php-cgi";
-    char command[strlen(format) + (strlen(path) - 2) + (strlen(query) - 2) + 1];
-    if (sprintf(command, format, query, path) < 0)
+    // execute successor, with its socket (and with no signals blocked, as they are
+    // while supervising workers)
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
     {
-        error(500);
-        return;
+        sigset_t set;
+        sigemptyset(&set);
+        sigprocmask(SIG_SETMASK, &set, NULL);
+        char fd[sizeof(int) * 3 + 1];
+        sprintf(fd, "%i", pair[1]);
+        if (fcntl(pair[1], F_SETFD, 0) == 0 && setenv("SERVER_ANCESTOR", fd, 1) == 0)
+        {
+            execvp(arguments[0], arguments);
+        }
+        _exit(127);
     }
-    FILE* file = popen(command, "r");
-    if (file == NULL)
+    close(pair[1]);
+    if (pid == -1)
     {
-        error(500);
-        return;
+        close(pair[0]);
+        return false;
     }
 
-    // load interpreter's content
-    char* content;
-    size_t length;
-    if (load(file, &content, &length) == false)
+    // hand down each socket (each worker's, if any), along with its address, whereby
+    // successor knows it, then an empty message, whereby successor knows it's the last
+    int n = (sockets != NULL) ? workers * nendpoints : nendpoints;
+    bool ok = true;
+    for (int i = 0; i < n && ok; i++)
     {
-        error(500);
-        return;
+        int fd = (sockets != NULL) ? sockets[i] : endpoints[i].fd;
+        struct iovec iov;
+        iov.iov_base = (void*) endpoints[i % nendpoints].address;
+        iov.iov_len = strlen(endpoints[i % nendpoints].address) + 1;
+        union
+        {
+            struct cmsghdr header;
+            char buffer[CMSG_SPACE(sizeof(int))];
+        }
+        control;
+        memset(&control, 0, sizeof(control));
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = sizeof(control.buffer);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+        ok = (sendmsg(pair[0], &msg, 0) != -1);
     }
+    ok = ok && (send(pair[0], "", 1, 0) == 1);
 
-    // close pipe
-    pclose(file);
-
-    // subtract php-cgi's headers from content's length to get body's length
-    char* haystack = content;
-    char* needle = strstr(haystack, "\r\n\r\n");
-    if (needle == NULL)
+    // wait for successor to say it's listening, which it never will if it stops first
+    char byte;
+    ssize_t bytes = -1;
+    while (ok && (bytes = read(pair[0], &byte, 1)) == -1 && errno == EINTR)
     {
-        free(content);
-        error(500);
-        return;
+        continue;
+    }
+    close(pair[0]);
+    if (!ok || bytes != 1)
+    {
+        kill(pid, SIGINT);
+        waitpid(pid, NULL, 0);
+        printf("\033[33m");
+        printf("Can't upgrade server");
+        printf("\033[39m\n");
+        return false;
     }
 
-    // extract headers
-    char headers[needle + 2 - haystack + 1];
-    strncpy(headers, content, needle + 2 - haystack);
-    headers[needle + 2 - haystack] = '\0';
-
-    // respond with interpreter's content
-    respond(200, headers, needle + 4, length - (needle - haystack + 4));
-
-    // free interpreter's content
-    free(content);
+    // leave unix sockets for successor to remove
+    for (int i = 0; i < nendpoints; i++)
+    {
+        endpoints[i].path = NULL;
+    }
+    printf("\033[33m");
+    printf("Upgraded server to process %i", (int) pid);
+    printf("\033[39m\n");
+    return true;
 }
 
 /**
- * Responds to client with directory listing of path.
+ * Opens stream id of HTTP/2 connection, as a connection of its own (albeit without
+ * a socket of its own), into whose buffer its request is then to be put. Returns
+ * stream, else NULL if out of memory.
  */
-void list(const char* path)
+struct connection* branch(struct connection* c, unsigned int id)
 {
-    // ensure path is readable and executable
-    if (access(path, R_OK | X_OK) == -1)
+    struct connection* t = recruit();
+    if (t == NULL)
     {
-        error(403);
-        return;
+        return NULL;
     }
-
-    // open directory
-    DIR* dir = opendir(path);
-    if (dir == NULL)
+    t->kind = CLIENT;
+    t->fd = c->fd;
+    t->file = -1;
+    t->state = READING;
+    memcpy(t->address, c->address, sizeof(t->address));
+    t->parent = c;
+    t->id = id;
+    t->window = c->session->initial;
+
+    // default to middling urgency
+    // https://tools.ietf.org/html/rfc9218#section-4.1
+    t->urgency = 3;
+
+    // append stream to connection's streams
+    struct connection** p = &c->session->streams;
+    while (*p != NULL)
     {
-        return;
+        p = &(*p)->sibling;
     }
+    *p = t;
+    c->session->nstreams++;
+    return t;
+}
 
-    // buffer for list items
-    char* list = malloc(1);
-    list[0] = '\0';
-
-    // iterate over directory entries
-    struct dirent** namelist = NULL;
-    int n = scandir(path, &namelist, NULL, alphasort);
-    for (int i = 0; i < n; i++)
+/**
+ * Packs headers and bodies of snapshot's entries into one read-only mapping,
+ * whose pages (being mapped before any workers are spawned) all workers share,
+ * whereupon root is frozen. Returns true iff successful.
+ */
+bool bundle(void)
+{
+    // size mapping, packing each entry but once (via its file's own route)
+    size_t size = 0;
+    for (size_t i = 0; i < nsnapshot; i++)
     {
-        // omit . from list
-        if (strcmp(namelist[i]->d_name, ".") == 0)
-        {
-            continue;
-        }
-
-        // escape entry's name
-        char* name = htmlspecialchars(namelist[i]->d_name);
-        if (name == NULL)
+        for (struct route* r = snapshot[i]; r != NULL; r = r->chain)
         {
-            free(list);
-            freedir(namelist, n);
-            error(500);
-            return;
+            for (int j = 0; r->entry != NULL && strcmp(r->entry->path, r->path) == 0 && j < CODINGS; j++)
+            {
+                if (r->entry->headers[j] != NULL)
+                {
+                    size += strlen(r->entry->headers[j]) + 1 + r->entry->length[j];
+                }
+            }
         }
+    }
 
-        // append list item to buffer
-        char* template = "<li><a href=\"%s\">%s</a></li>";
-        list = realloc(list, strlen(list) + strlen(template) - 2 + strlen(name) - 2 + strlen(name) + 1);
-        if (list == NULL)
+    // copy entries' headers and bodies into mapping, freeing originals
+    if (size > 0)
+    {
+        bundled = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (bundled == MAP_FAILED)
         {
-            free(name);
-            freedir(namelist, n);
-            error(500);
-            return;
+            bundled = NULL;
+            return false;
         }
-        if (sprintf(list + strlen(list), template, name, name) < 0)
+        nbundled = size;
+    }
+    BYTE* p = bundled;
+    for (size_t i = 0; i < nsnapshot; i++)
+    {
+        for (struct route* r = snapshot[i]; r != NULL; r = r->chain)
         {
-            free(name);
-            freedir(namelist, n);
-            free(list);
-            error(500);
-            return;
+            struct entry* e = r->entry;
+            for (int j = 0; e != NULL && strcmp(e->path, r->path) == 0 && j < CODINGS; j++)
+            {
+                if (e->headers[j] != NULL)
+                {
+                    size_t n = strlen(e->headers[j]) + 1;
+                    memcpy(p, e->headers[j], n);
+                    free(e->headers[j]);
+                    e->headers[j] = p;
+                    p += n;
+                    memcpy(p, e->body[j], e->length[j]);
+                    free(e->body[j]);
+                    e->body[j] = p;
+                    p += e->length[j];
+                }
+            }
         }
+    }
+
+    // protect mapping from writes
+    if (bundled != NULL && mprotect(bundled, size, PROT_READ) == -1)
+    {
+        return false;
+    }
+    frozen = true;
+    return true;
+}
 
-        // free escaped name
-        free(name);
+/**
+ * Caches body, of length bytes and MIME type type, as the content of path, whose
+ * metadata is sb, evicting least recently used entries as needed to stay within
+ * budget. Returns entry, which then owns body, else NULL if it can't be cached,
+ * in which case body remains caller's.
+ */
+struct entry* cache(const char* path, const struct stat* sb, const char* type, BYTE* body, size_t length)
+{
+    // ensure entry fits within budget
+    size_t cost = sizeof(struct entry) + strlen(path) + 1 + length;
+    if (cost > budget)
+    {
+        return NULL;
     }
 
-    // free memory allocated by scandir
-    freedir(namelist, n);
+    // allocate entry
+    struct entry* e = calloc(1, sizeof(struct entry));
+    if (e == NULL)
+    {
+        return NULL;
+    }
+    e->path = strdup(path);
+    e->type = type;
+    int n = label(NULL, 0, type, IDENTITY, sb);
+    e->headers[IDENTITY] = malloc(n + 1);
+    if (e->path == NULL || e->headers[IDENTITY] == NULL || n < 0)
+    {
+        release(e);
+        return NULL;
+    }
+    label(e->headers[IDENTITY], n + 1, type, IDENTITY, sb);
+    cost += n + 1;
 
-    // prepare response
-    const char* relative = path + strlen(root);
-    char* template = "<html><head><title>%s</title></head><body><h1>%s</h1><ul>%s</ul></body></html>";
-    char body[strlen(template) - 2 + strlen(relative) - 2 + strlen(relative) - 2 + strlen(list) + 1];
-    int length = sprintf(body, template, relative, relative, list);
-    if (length < 0)
+    // remember (file or directory's) identity
+    e->sb = *sb;
+
+    // trust inotify to report changes to file or directory (unless it's a symbolic
+    // link, whose target could be anywhere), else validate entry on each hit
+    char link[strlen(path) + 1];
+    strcpy(link, path);
+    if (link[0] != '\0' && link[strlen(link) - 1] == '/')
     {
-        free(list);
-        closedir(dir);
-        error(500);
-        return;
+        link[strlen(link) - 1] = '\0';
     }
+    struct stat lsb;
+    e->watched = (lstat(link, &lsb) == 0 && !S_ISLNK(lsb.st_mode) && observe(path));
 
-    // free buffer
-    free(list);
+    // grow hash table as needed, so that chains stay short
+    if (entries >= nbuckets)
+    {
+        size_t m = (nbuckets == 0) ? 1024 : nbuckets * 2;
+        struct entry** b = calloc(m, sizeof(struct entry*));
+        if (b == NULL)
+        {
+            release(e);
+            return NULL;
+        }
+        for (size_t i = 0; i < nbuckets; i++)
+        {
+            while (buckets[i] != NULL)
+            {
+                struct entry* next = buckets[i]->chain;
+                buckets[i]->chain = b[buckets[i]->hash & (m - 1)];
+                b[buckets[i]->hash & (m - 1)] = buckets[i];
+                buckets[i] = next;
+            }
+        }
+        free(buckets);
+        buckets = b;
+        nbuckets = m;
+    }
 
-    // close directory
-    closedir(dir);
+    // insert entry into hash table
+    e->hash = hash(path);
+    e->chain = buckets[e->hash & (nbuckets - 1)];
+    buckets[e->hash & (nbuckets - 1)] = e;
+    entries++;
 
-    // respond with list
-    char* headers = "Content-Type: text/html\r\n";
-    respond(200, headers, body, length);
+    // insert entry at front of list
+    e->colder = hottest;
+    if (hottest != NULL)
+    {
+        hottest->hotter = e;
+    }
+    else
+    {
+        coldest = e;
+    }
+    hottest = e;
+
+    // evict least recently used entries until cache fits within budget
+    e->body[IDENTITY] = body;
+    e->length[IDENTITY] = length;
+    e->tried[IDENTITY] = true;
+    e->references = 1;
+    e->cached = true;
+    used += cost;
+    while (used > budget && coldest != e)
+    {
+        evict(coldest);
+    }
+    return e;
 }
 
-
 /**
- * Loads a file into memory dynamically allocated on heap.
- * Stores address thereof in *content and length thereof in *length.
+ * Looks up path in cache, validating entry against file unless inotify
+ * would have reported changes. Returns entry, else NULL.
  */
-bool load(FILE* file, BYTE** content, size_t* length)
+struct entry* cached(const char* path)
 {
-    if (file == NULL)
+    // look up path in snapshot first, if root's frozen, whose entries needn't be validated
+    if (frozen)
+    {
+        struct route* r = locate(path);
+        if (r != NULL && r->entry != NULL)
+        {
+            return r->entry;
+        }
+    }
+
+    // ensure cache isn't empty
+    if (entries == 0)
     {
-    	content = NULL;
-    	length = NULL;
-	    return false;
+        return NULL;
     }
 
-    // Get file length
-    fseek(file, 0 , SEEK_END);
-    *length = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    // search path's bucket
+    unsigned long h = hash(path);
+    struct entry* e = buckets[h & (nbuckets - 1)];
+    while (e != NULL && (e->hash != h || strcmp(e->path, path) != 0))
+    {
+        e = e->chain;
+    }
+    if (e == NULL)
+    {
+        return NULL;
+    }
 
-    // Allocating content buffer in heap
-    BYTE* buffer = (BYTE*) malloc(*length + 1);
-    if(buffer == NULL)
+    // validate entry against file, if inotify isn't watching file
+    if (!e->watched)
     {
-    	content = NULL;
-    	length = NULL;
-    	return false;
+        struct stat sb;
+        if (stat(path, &sb) == -1 || sb.st_dev != e->sb.st_dev || sb.st_ino != e->sb.st_ino
+            || sb.st_mode != e->sb.st_mode || sb.st_size != e->sb.st_size || sb.st_mtime != e->sb.st_mtime)
+        {
+            evict(e);
+            return NULL;
+        }
     }
 
-    // Loading file into Content buffer
-    fread(buffer, *length, 1, file);
-    *content = buffer;
-    return true;
+    // move entry to front of list
+    if (e != hottest)
+    {
+        e->hotter->colder = e->colder;
+        if (e->colder != NULL)
+        {
+            e->colder->hotter = e->hotter;
+        }
+        else
+        {
+            coldest = e->hotter;
+        }
+        e->hotter = NULL;
+        e->colder = hottest;
+        hottest->hotter = e;
+        hottest = e;
+    }
+    return e;
 }
 
 /**
- * Returns MIME type for supported extensions, else NULL.
+ * Queues data of specified length as a chunk of connection's response, unless
+ * length is 0, in which case the last chunk is queued. Returns true iff successful.
+ *
+ * https://tools.ietf.org/html/rfc7230#section-4.1
  */
-const char* lookup(const char* path)
+bool chunk(struct connection* c, const BYTE* data, size_t length)
 {
-    // Get file extension
-    char* ext = strrchr(path, '.');
-    
-    // Define MIME type
-    const char* type;
-    if(strcasecmp(ext, ".css") == 0)
+    // let streams frame data instead
+    if (c->parent != NULL)
+    {
+        if (!grow(c, length))
+        {
+            return false;
+        }
+        if (length > 0)
+        {
+            memcpy(c->response + c->size, data, length);
+        }
+        c->size += length;
+        return true;
+    }
+
+    // chunk-size in hex, followed by chunk itself (or by CRLF alone, if last)
+    char size[sizeof(size_t) * 2 + 3];
+    int n = sprintf(size, "%zx\r\n", length);
+    if (!grow(c, n + length + 2))
+    {
+        return false;
+    }
+    memcpy(c->response + c->size, size, n);
+    if (length > 0)
     {
-        type = "text/css";
+        memcpy(c->response + c->size + n, data, length);
     }
-    else if(strcasecmp(ext, ".html") == 0)
+    memcpy(c->response + c->size + n + length, "\r\n", 2);
+    c->size += n + length + 2;
+    return true;
+}
+
+/**
+ * Returns true iff files of MIME type type (e.g., text/html, but not image/jpeg)
+ * are worth compressing.
+ */
+bool compressible(const char* type)
+{
+    if (type == NULL)
     {
-        type = "text/html";
+        return false;
     }
-    else if(strcasecmp(ext, ".gif") == 0)
+    size_t n = strcspn(type, ";");
+    return strncasecmp(type, "text/", strlen("text/")) == 0
+        || (n >= strlen("+xml") && strncasecmp(type + n - strlen("+xml"), "+xml", strlen("+xml")) == 0)
+        || (n >= strlen("+json") && strncasecmp(type + n - strlen("+json"), "+json", strlen("+json")) == 0)
+        || (n == strlen("application/javascript") && strncasecmp(type, "application/javascript", n) == 0)
+        || (n == strlen("application/json") && strncasecmp(type, "application/json", n) == 0)
+        || (n == strlen("application/xml") && strncasecmp(type, "application/xml", n) == 0);
+}
+
+/**
+ * Chooses (via ALPN) HTTP/2 if client offers it, else HTTP/1.1, proceeding without
+ * either if client offers neither. Returns SSL_TLSEXT_ERR_OK, else SSL_TLSEXT_ERR_NOACK.
+ * https://tools.ietf.org/html/rfc7301#section-3.2
+ * https://tools.ietf.org/html/rfc7540#section-3.3
+ */
+int choose(SSL* ssl, const unsigned char** out, unsigned char* outlen, const unsigned char* in, unsigned int inlen,
+    void* arg)
+{
+    static const unsigned char protocols[] = "\x02h2\x08http/1.1";
+    if (SSL_select_next_proto((unsigned char**) out, outlen, protocols, sizeof(protocols) - 1, in, inlen)
+        != OPENSSL_NPN_NEGOTIATED)
     {
-        type = "image/gif";
+        return SSL_TLSEXT_ERR_NOACK;
     }
-    else if(strcasecmp(ext, ".ico") == 0)
+    return SSL_TLSEXT_ERR_OK;
+}
+
+/**
+ * Copies n bytes of s (or as many thereof as fit) into buffer, of size bytes,
+ * terminating it.
+ */
+void clip(char* buffer, size_t size, const char* s, size_t n)
+{
+    n = (n < size) ? n : size - 1;
+    memcpy(buffer, s, n);
+    buffer[n] = '\0';
+}
+
+/**
+ * Commences stream whose header block HTTP/2 connection has gathered, decoding
+ * block into stream's request (as HTTP/1.1's, so that it's handled just as one
+ * read from a socket would be) and dispatching it, unless stream is to be refused
+ * or reset, or block opens no stream (as trailers don't), in which case block is
+ * decoded just to keep table in sync. Returns false iff connection is to be abandoned.
+ * https://tools.ietf.org/html/rfc7540#section-8.1
+ */
+bool commence(struct connection* c)
+{
+    struct session* s = c->session;
+    unsigned int id = s->opening;
+    bool novel = (id > s->highest);
+    if (novel)
     {
-        type = "image/x-ico";
+        s->highest = id;
     }
-    else if(strcasecmp(ext, ".jpg") == 0)
+
+    // decode block into stream's buffer, if stream is to be opened, else into scratch
+    struct connection* t = NULL;
+    if (novel && !s->going && s->nstreams < Http2MaxConcurrentStreams)
     {
-        type = "image/jpeg";
+        t = branch(c, id);
     }
-    else if(strcasecmp(ext, ".js") == 0)
+    char scratch[BUFFER];
+    size_t length = 0;
+    int result = unpack(s, (const unsigned char*) s->block, s->gathered, (t != NULL) ? t->message : scratch,
+        &length, (t != NULL) ? &t->urgency : NULL);
+    if (result < 0)
     {
-        type = "text/javascript";
+        return abandon(c, HTTP2_COMPRESSION_ERROR);
     }
-    else if(strcasecmp(ext, ".php") == 0)
+    if (!novel)
     {
-        type = "text/x-php";
+        return true;
     }
-    else if(strcasecmp(ext, ".png") == 0)
+    if (t == NULL)
     {
-        type = "image/png";
+        notify(c, HTTP2_RST_STREAM, id, HTTP2_REFUSED_STREAM);
+        return true;
     }
-    else
+    if (result > 0)
     {
-        type = NULL;
+        notify(c, HTTP2_RST_STREAM, id, HTTP2_PROTOCOL_ERROR);
+        t->ended = true;
+        hangup(t);
+        return true;
     }
-    return type;
-}   
+
+    // dispatch request, as though stream had read it
+    t->length = length;
+    advance(t);
+    return true;
+}
 
 /**
- * Parses a request-line, storing its absolute-path at abs_path 
- * and its query string at query, both of which are assumed
- * to be at least of length LimitRequestLine + 1.
+ * Collects sockets handed down (via SCM_RIGHTS) by predecessor, if server's been
+ * executed by one (i.e., is upgrading it), to be listened on instead of sockets
+ * anew for the same addresses. Returns true iff successful.
  */
-bool parse(const char* line, char* abs_path, char* query)
+bool collect(void)
 {
-	// Look for first space in request line
-	char* firstSpace = strchr(line, ' ');
-	
-	// Bad Request has no space
-	if(firstSpace == NULL)
-	{
-		error(400);
-		return false;
-	}
-
-	// Extract method name
-	int methodSize = (int)(firstSpace - line);
-	char method[methodSize + 1];
-	strncpy(method, line, methodSize);
-	method[methodSize] = '\0';
+    // ensure server has a predecessor
+    const char* fd = getenv("SERVER_ANCESTOR");
+    if (fd == NULL)
+    {
+        return true;
+    }
+    ancestor = atoi(fd);
+    unsetenv("SERVER_ANCESTOR");
+    if (fcntl(ancestor, F_SETFD, FD_CLOEXEC) == -1)
+    {
+        ancestor = -1;
+        return false;
+    }
 
-	
-	// Method not allowed other than GET
-	if (strcmp(method, "GET"))
-	{
-		error(405);
-		return false;
+    // receive sockets, each with its address, until an empty message
+    while (true)
+    {
+        char address[BYTES];
+        struct iovec iov;
+        iov.iov_base = address;
+        iov.iov_len = sizeof(address) - 1;
+        union
+        {
+            struct cmsghdr header;
+            char buffer[CMSG_SPACE(sizeof(int))];
+        }
+        control;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = sizeof(control.buffer);
+        ssize_t bytes = recvmsg(ancestor, &msg, MSG_CMSG_CLOEXEC);
+        if (bytes == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            return false;
+        }
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg == NULL)
+        {
+            break;
+        }
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+        {
+            return false;
+        }
+        struct endpoint* e = realloc(inherited, (ninherited + 1) * sizeof(struct endpoint));
+        if (e == NULL)
+        {
+            return false;
+        }
+        inherited = e;
+        address[bytes] = '\0';
+        inherited[ninherited].kind = LISTENER;
+        inherited[ninherited].address = strdup(address);
+        memcpy(&inherited[ninherited].fd, CMSG_DATA(cmsg), sizeof(int));
+        inherited[ninherited].path = NULL;
+        if (inherited[ninherited++].address == NULL)
+        {
+            return false;
+        }
+    }
+
+    // announce sockets
+    printf("\033[33m");
+    printf("Inheriting %i sockets from predecessor", ninherited);
+    printf("\033[39m\n");
+    return true;
+}
+
+/**
+ * Collects (without blocking) completions of jobs, whether via io_uring or threads,
+ * submitting jobs' next phases, if any, else resuming their clients.
+ */
+void complete(void)
+{
+    // reset eventfd's counter (or drain pipe) before collecting completions,
+    // so that any reported thereafter aren't missed
+    BYTE buffer[BYTES];
+    while (read(nfd[0], buffer, sizeof(buffer)) > 0);
+
+    // collect jobs completed by threads
+    pthread_mutex_lock(&lock);
+    struct job* done = completed;
+    completed = NULL;
+    pthread_mutex_unlock(&lock);
+
+#ifdef __linux__
+    // collect completions from io_uring, submitting each job's next phase, if any
+    unsigned int head = (ufd != -1) ? *cqhead : 0;
+    while (ufd != -1 && head != __atomic_load_n(cqtail, __ATOMIC_ACQUIRE))
+    {
+        struct io_uring_cqe* cqe = &cqes[head & *cqmask];
+        struct job* j = (struct job*) (uintptr_t) cqe->user_data;
+        int res = cqe->res;
+        head++;
+        __atomic_store_n(cqhead, head, __ATOMIC_RELEASE);
+        flying--;
+
+        switch (j->phase)
+        {
+            // file opened, else job failed
+            case OPENING:
+                if (res < 0)
+                {
+                    j->error = -res;
+                    j->phase = DONE;
+                }
+                else
+                {
+                    j->file = res;
+                    j->phase = STATING;
+                }
+                break;
+
+            // file's metadata determined, whereafter its content is to be loaded
+            // if small enough to cache
+            case STATING:
+                if (res < 0)
+                {
+                    j->error = -res;
+                    j->phase = DONE;
+                    break;
+                }
+                j->sb.st_dev = makedev(j->stx.stx_dev_major, j->stx.stx_dev_minor);
+                j->sb.st_ino = j->stx.stx_ino;
+                j->sb.st_mode = j->stx.stx_mode;
+                j->sb.st_nlink = j->stx.stx_nlink;
+                j->sb.st_uid = j->stx.stx_uid;
+                j->sb.st_gid = j->stx.stx_gid;
+                j->sb.st_size = j->stx.stx_size;
+                j->sb.st_mtim.tv_sec = j->stx.stx_mtime.tv_sec;
+                j->sb.st_mtim.tv_nsec = j->stx.stx_mtime.tv_nsec;
+                j->phase = DONE;
+                if (j->sb.st_size <= CacheMaxFileSize)
+                {
+                    j->body = malloc(j->sb.st_size + 1);
+                    j->phase = (j->body != NULL) ? LOADING : DONE;
+                }
+                break;
+
+            // some (if not all) of file's content loaded, else file proved shorter
+            // than it seemed, in which case it's to be sent from page cache instead
+            case LOADING:
+                if (res == -EINTR || res == -EAGAIN)
+                {
+                    break;
+                }
+                if (res <= 0)
+                {
+                    free(j->body);
+                    j->body = NULL;
+                    j->phase = DONE;
+                    break;
+                }
+                j->length += res;
+                if (j->length == j->sb.st_size)
+                {
+                    j->phase = DONE;
+                }
+                break;
+
+            case DONE:
+                break;
+        }
+
+        // submit job's next phase, else finish it synchronously if ring is full
+        if (j->phase != DONE && !submit(j))
+        {
+            perform(j);
+        }
+        if (j->phase == DONE)
+        {
+            j->next = done;
+            done = j;
+        }
+    }
+#endif
+
+    // resume clients of completed jobs, discarding any whose clients hung up
+    while (done != NULL)
+    {
+        struct job* j = done;
+        done = j->next;
+        struct connection* c = j->client;
+        if (c == NULL)
+        {
+            if (j->file != -1)
+            {
+                close(j->file);
+            }
+            free(j->body);
+            free(j->path);
+            free(j);
+            continue;
+        }
+        c->job = NULL;
+        client = c;
+        resume(j);
+        client = NULL;
+        c->state = WRITING;
+        advance(c);
+    }
+}
+
+/**
+ * Responds to backend's client with backend's response (if ok, else with 502),
+ * or ends response's chunks if already streaming (closing connection if not ok,
+ * so that client can tell response is incomplete), detaching backend from client,
+ * after which client's connection is advanced.
+ */
+void conclude(struct backend* b, bool ok)
+{
+    struct connection* c = b->client;
+    measure(c, PHP, nanotime() - b->began);
+    bool truncated = false;
+    if (b->streaming)
+    {
+        if (!ok || !chunk(c, NULL, 0))
+        {
+            c->keepalive = false;
+            truncated = true;
+        }
+    }
+
+    // respond on client's behalf, even if in midst of serving another
+    else
+    {
+        struct connection* saved = client;
+        client = c;
+        if (!ok || !reply(b->output, b->produced, false))
+        {
+            error(502);
+        }
+        client = saved;
+    }
+    detach(b, ok);
+
+    // reset stream, rather than end it, if response was cut short, lest client
+    // mistake it for complete (much as closing connection tells an HTTP/1.1 client)
+    if (truncated && c->parent != NULL && c->state == WAITING)
+    {
+        c->state = CLOSING;
+        advance(c);
+        return;
+    }
+
+    // resume client, unless it's still being dispatched (and so will be resumed anyway)
+    if (c->state == WAITING)
+    {
+        c->state = WRITING;
+        advance(c);
+    }
+}
+
+/**
+ * Accepts (without blocking) a client that has connected to endpoint, if any,
+ * watching its socket for readiness. Returns client's connection, else NULL.
+ */
+struct connection* connected(struct endpoint* e)
+{
+    while (true)
+    {
+        struct sockaddr_storage cli_addr;
+        memset(&cli_addr, 0, sizeof(cli_addr));
+        socklen_t cli_len = sizeof(cli_addr);
+#ifdef __linux__
+        int fd = accept4(e->fd, (struct sockaddr*) &cli_addr, &cli_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        int fd = accept(e->fd, (struct sockaddr*) &cli_addr, &cli_len);
+        if (fd != -1 && fcntl(fd, F_SETFL, O_NONBLOCK) == -1)
+        {
+            close(fd);
+            continue;
+        }
+#endif
+        if (fd == -1)
+        {
+            // retry if interrupted or if client gave up before being accepted
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            return NULL;
+        }
+
+        // note client's address (an IPv4-mapped one as IPv4's, and a unix socket's
+        // clients' as unix:)
+        char address[INET6_ADDRSTRLEN] = "unix:";
+        if (cli_addr.ss_family == AF_INET6)
+        {
+            const struct in6_addr* a = &((const struct sockaddr_in6*) &cli_addr)->sin6_addr;
+            if (IN6_IS_ADDR_V4MAPPED(a))
+            {
+                inet_ntop(AF_INET, &a->s6_addr[12], address, sizeof(address));
+            }
+            else
+            {
+                inet_ntop(AF_INET6, a, address, sizeof(address));
+            }
+        }
+        else if (cli_addr.ss_family == AF_INET)
+        {
+            inet_ntop(AF_INET, &((const struct sockaddr_in*) &cli_addr)->sin_addr, address, sizeof(address));
+        }
+
+        // refuse client (as best as can be without blocking) if this worker, or client's
+        // address, has as many connections as it may
+        if (meter->connections >= (unsigned long long) capacity || !admit(address))
+        {
+            const char* refusal = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            if (tls == NULL && write(fd, refusal, strlen(refusal)) == -1)
+            {
+                // client will notice socket's closure instead (as a TLS client
+                // always does, since refusal can't be sent before a handshake)
+            }
+            close(fd);
+            tally(&meter->refused, 1);
+            continue;
+        }
+
+        // reuse a spare connection, if any, else allocate one, dropping client if out of memory
+        struct connection* c = recruit();
+        if (c == NULL)
+        {
+            dismiss(address);
+            close(fd);
+            continue;
+        }
+
+        // prepare to complete TLS handshake as server, if serving HTTPS
+        if (tls != NULL && ((c->ssl = SSL_new(tls)) == NULL || SSL_set_fd(c->ssl, fd) != 1))
+        {
+            SSL_free(c->ssl);
+            dismiss(address);
+            close(fd);
+            retire(c);
+            continue;
+        }
+        if (c->ssl != NULL)
+        {
+            SSL_set_accept_state(c->ssl);
+        }
+
+        // send small responses right away, since each is written all at once
+        int optval = 1;
+        if (cli_addr.ss_family != AF_UNIX)
+        {
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+        }
+
+        c->kind = CLIENT;
+        c->fd = fd;
+        c->file = -1;
+        c->state = READING;
+        memcpy(c->address, address, sizeof(c->address));
+        timeout(c, KeepAliveTimeout);
+
+        // watch client's socket
+        if (!watch(fd, c))
+        {
+            timeout(c, 0);
+            SSL_free(c->ssl);
+            dismiss(address);
+            close(fd);
+            retire(c);
+            continue;
+        }
+        tally(&meter->connections, 1);
+        connections++;
+        return c;
+    }
+}
+
+/**
+ * Formats in buffer (of size bytes) headers of connection's part of a multipart/byteranges
+ * response, preceded by its delimiter, else (if part is connection's number of parts)
+ * closing delimiter, per snprintf, unless buffer is NULL. Returns length thereof.
+ * https://tools.ietf.org/html/rfc7233#appendix-A
+ */
+int delimit(char* buffer, size_t size, const struct connection* c, int part)
+{
+    if (part == c->parts)
+    {
+        return snprintf(buffer, size, "\r\n--%s--\r\n", boundary);
+    }
+    return snprintf(buffer, size, "\r\n--%s\r\nContent-Type: %s\r\nContent-Range: bytes %lld-%lld/%lld\r\n\r\n",
+        boundary, c->type, (long long) c->ranges[part].first, (long long) c->ranges[part].last, (long long) c->total);
+}
+
+/**
+ * Responds to client with cached entry, whose body is sent straight from cache,
+ * in client's most preferred content-coding thereof (encoding body therein,
+ * if not tried before). Returns true iff response has been queued.
+ */
+bool deliver(struct entry* e)
+{
+    enum coding coding = IDENTITY;
+    for (int i = CODINGS - 1; i > IDENTITY && coding == IDENTITY; i--)
+    {
+        if ((client->accepts & (1 << i)) && encode(e, i))
+        {
+            coding = i;
+        }
+    }
+
+    // attach body to client, then respond with it (or ranges thereof), unless
+    // client's copy is fresh
+    char etag[BYTES / 4];
+    if (tag(etag, sizeof(etag), &e->sb, coding) < 0)
+    {
+        return false;
+    }
+    e->references++;
+    client->entry = e;
+    client->coding = coding;
+    client->body = e->body[coding];
+    client->extent = e->length[coding];
+    return represent(e->headers[coding], e->type, e->length[coding], etag, e->sb.st_mtime) != 0;
+}
+
+/**
+ * Detaches backend from its client (if any), returning backend to pool if it's reusable
+ * (and pool isn't full), else closing backend (and freeing it later).
+ */
+void detach(struct backend* b, bool reusable)
+{
+    if (b->client != NULL)
+    {
+        b->client->backend = NULL;
+        b->client = NULL;
+    }
+
+    // discard request and response
+    free(b->request);
+    b->request = NULL;
+    b->size = b->sent = 0;
+    free(b->input);
+    b->input = NULL;
+    b->length = 0;
+    free(b->output);
+    b->output = NULL;
+    b->produced = 0;
+    b->streaming = false;
+    b->responded = false;
+
+    // return backend to pool
+    if (reusable && b->fd != -1 && pooled < FastCGIConnections)
+    {
+        b->next = pool;
+        pool = b;
+        pooled++;
+        return;
+    }
+
+    // close backend
+    if (b->fd != -1)
+    {
+        close(b->fd);
+        b->fd = -1;
+    }
+    b->next = discarded;
+    discarded = b;
+}
+
+/**
+ * Connects (without blocking) backend to FastCGI's socket, watching backend's
+ * socket for readiness. Returns true iff successful.
+ */
+bool dial(struct backend* b)
+{
+    // FastCGI's socket
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (fastcgi == NULL || strlen(fastcgi) >= sizeof(addr.sun_path))
+    {
+        return false;
+    }
+    strcpy(addr.sun_path, fastcgi);
+
+    // connect to socket without blocking
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        return false;
+    }
+    if (fcntl(fd, F_SETFL, O_NONBLOCK) == -1 || fcntl(fd, F_SETFD, FD_CLOEXEC) == -1
+        || (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) == -1 && errno != EINPROGRESS)
+        || !watch(fd, b))
+    {
+        close(fd);
+        return false;
+    }
+    b->fd = fd;
+    b->reused = false;
+    return true;
+}
+
+/**
+ * Uncounts a connection from client's address (unless a unix socket's), forgetting
+ * address once it has none, and shifting back any addresses that collided with it,
+ * so that table needs no tombstones.
+ */
+void dismiss(const char* address)
+{
+    if (quota == 0 || strcmp(address, "unix:") == 0)
+    {
+        return;
+    }
+    size_t i = hash(address) % npeers;
+    while (peers[i].connections > 0 && strcmp(peers[i].address, address) != 0)
+    {
+        i = (i + 1) % npeers;
+    }
+    if (peers[i].connections == 0 || --peers[i].connections > 0)
+    {
+        return;
+    }
+    for (size_t j = (i + 1) % npeers; peers[j].connections > 0; j = (j + 1) % npeers)
+    {
+        // move address at j back into vacancy at i, unless its own slot lies
+        // cyclically within (i, j], whence it'd no longer be found
+        size_t k = hash(peers[j].address) % npeers;
+        if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j))
+        {
+            peers[i] = peers[j];
+            peers[j].connections = 0;
+            i = j;
+        }
+    }
+}
+
+/**
+ * Formats every note jotted but not yet written, writing them to access log in
+ * batches. Must be called with logging locked.
+ */
+void drain(void)
+{
+    // batch of lines, along with time as last formatted (once per second at most)
+    static char batch[BUFFER * 4];
+    static time_t formatted = -1;
+    static char when[BYTES / 8];
+
+    size_t length = 0;
+    unsigned long head = __atomic_load_n(&jotted, __ATOMIC_ACQUIRE);
+    for (unsigned long i = scribed; i <= head; i++)
+    {
+        // format note, if any remains, as a line
+        char line[BYTES * 8];
+        int n = 0;
+        if (i < head)
+        {
+            const struct note* note = &notes[i & (NOTES - 1)];
+            if (note->time != formatted)
+            {
+                struct tm tm;
+                localtime_r(&note->time, &tm);
+                strftime(when, sizeof(when), json ? "%Y-%m-%dT%H:%M:%S%z" : "%d/%b/%Y:%H:%M:%S %z", &tm);
+                formatted = note->time;
+            }
+            char request[sizeof(note->request) * 6];
+            char referer[sizeof(note->referer) * 6];
+            char agent[sizeof(note->agent) * 6];
+            escape(request, note->request, json);
+            escape(referer, note->referer, json);
+            escape(agent, note->agent, json);
+            if (json)
+            {
+                n = snprintf(line, sizeof(line), "{\"time\": \"%s\", \"address\": \"%s\", \"request\": \"%s\", "
+                    "\"status\": %i, \"bytes\": %llu, \"referer\": \"%s\", \"agent\": \"%s\", \"duration_us\": %lld, "
+                    "\"trace_id\": \"%s\", \"span_id\": \"%s\", \"parent_span_id\": \"%s\", \"stages_ns\": {",
+                    when, note->address, request, note->code, note->bytes, referer, agent, note->duration / 1000,
+                    note->trace, note->span, note->parent);
+                for (int s = 0; s < REQUEST && n < (int) sizeof(line); s++)
+                {
+                    n += snprintf(line + n, sizeof(line) - n, "%s\"%s\": %lld", (s > 0) ? ", " : "",
+                        stages[s], note->spans[s]);
+                }
+                if (n < (int) sizeof(line))
+                {
+                    n += snprintf(line + n, sizeof(line) - n, "}}\n");
+                }
+            }
+            else
+            {
+                n = snprintf(line, sizeof(line), "%s - - [%s] \"%s\" %i %llu \"%s\" \"%s\" %lld\n",
+                    note->address, when, request, note->code, note->bytes, (referer[0] != '\0') ? referer : "-",
+                    (agent[0] != '\0') ? agent : "-", note->duration / 1000);
+            }
+            n = (n < (int) sizeof(line)) ? n : (int) sizeof(line) - 1;
+        }
+
+        // write batch once it's full (or notes have run out), giving up on it on error
+        if (length + n > sizeof(batch) || i == head)
+        {
+            for (size_t sent = 0; sent < length; )
+            {
+                ssize_t bytes = write(lfd, batch + sent, length - sent);
+                if (bytes == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (bytes <= 0)
+                {
+                    break;
+                }
+                sent += bytes;
+            }
+            length = 0;
+        }
+        memcpy(batch + length, line, n);
+        length += n;
+    }
+    __atomic_store_n(&scribed, head, __ATOMIC_RELEASE);
+}
+
+/**
+ * Emits value at p as an HPACK integer with an n-bit prefix, the other bits of
+ * whose first byte are first's. Returns number of bytes emitted.
+ * https://tools.ietf.org/html/rfc7541#section-5.1
+ */
+size_t emit(BYTE* p, int first, int n, size_t value)
+{
+    size_t max = (1 << n) - 1;
+    if (value < max)
+    {
+        p[0] = first | value;
+        return 1;
+    }
+    p[0] = first | max;
+    size_t i = 1;
+    for (value -= max; value >= 128; value >>= 7)
+    {
+        p[i++] = (value & 0x7f) | 0x80;
+    }
+    p[i++] = value;
+    return i;
+}
+
+/**
+ * Encodes entry's body in coding, from file's precompressed sibling if any (and
+ * small enough to cache), else on the fly, unless already tried. Returns true iff
+ * entry's body is available in coding (i.e., compressing it was worthwhile).
+ */
+bool encode(struct entry* e, enum coding coding)
+{
+    // encode entry's body at most once per coding
+    if (e->tried[coding])
+    {
+        return e->body[coding] != NULL;
+    }
+    e->tried[coding] = true;
+    if (!compressible(e->type))
+    {
+        return false;
+    }
+
+    // load precompressed sibling, if any
+    BYTE* body = NULL;
+    size_t length = 0;
+    struct stat sb;
+    int file = sibling(e->path, coding, &sb);
+    if (file != -1)
+    {
+        if (sb.st_size <= CacheMaxFileSize)
+        {
+            body = load(file, sb.st_size);
+            length = sb.st_size;
+        }
+        close(file);
+    }
+
+    // else compress body on the fly
+    if (body == NULL && coding == GZIP)
+    {
+        z_stream z;
+        memset(&z, 0, sizeof(z));
+        if (deflateInit2(&z, DeflateCompressionLevel, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return false;
+        }
+        length = deflateBound(&z, e->length[IDENTITY]);
+        body = malloc(length);
+        if (body != NULL)
+        {
+            z.next_in = (Bytef*) e->body[IDENTITY];
+            z.avail_in = e->length[IDENTITY];
+            z.next_out = (Bytef*) body;
+            z.avail_out = length;
+            if (deflate(&z, Z_FINISH) == Z_STREAM_END)
+            {
+                length = z.total_out;
+            }
+            else
+            {
+                free(body);
+                body = NULL;
+            }
+        }
+        deflateEnd(&z);
+    }
+    else if (body == NULL && coding == BROTLI)
+    {
+        length = BrotliEncoderMaxCompressedSize(e->length[IDENTITY]);
+        body = (length > 0) ? malloc(length) : NULL;
+        if (body != NULL && !BrotliEncoderCompress(BrotliCompressionQuality, BROTLI_DEFAULT_WINDOW,
+            BROTLI_MODE_TEXT, e->length[IDENTITY], (const uint8_t*) e->body[IDENTITY], &length, (uint8_t*) body))
+        {
+            free(body);
+            body = NULL;
+        }
+    }
+
+    // keep encoding only if it's smaller than body itself and fits within budget
+    int n = label(NULL, 0, e->type, coding, &e->sb);
+    size_t cost = length + n + 1;
+    if (body == NULL || length >= e->length[IDENTITY] || n < 0 || !e->cached || (!e->packed && used + cost > budget))
+    {
+        free(body);
+        return false;
+    }
+    e->headers[coding] = malloc(n + 1);
+    if (e->headers[coding] == NULL)
+    {
+        free(body);
+        return false;
+    }
+    label(e->headers[coding], n + 1, e->type, coding, &e->sb);
+    e->body[coding] = body;
+    e->length[coding] = length;
+    used += e->packed ? 0 : cost;
+    return true;
+}
+
+/**
+ * Responds to client with specified status code.
+ */
+void error(unsigned short code)
+{
+    // ensure code has a page
+    if (code >= sizeof(statuses) / sizeof(statuses[0]) || statuses[code].page == NULL)
+    {
+        return;
+    }
+
+    // close connection after most errors, since request might
+    // not have been as long (or as short) as it seemed
+    if (client != NULL && code != 403 && code != 404)
+    {
+        client->keepalive = false;
+    }
+
+    // respond with error's page
+    respond(code, "Content-Type: text/html\r\n", statuses[code].page, statuses[code].size);
+}
+
+/**
+ * Escapes string for access log into buffer, which must have room for it even
+ * if every character is escaped (i.e., 6 bytes per character, plus 1), escaping
+ * quotes and backslashes with backslashes and other bytes that aren't printable
+ * ASCII in hex, per JSON if json, else as Apache does. Returns escaped length.
+ */
+size_t escape(char* buffer, const char* s, bool json)
+{
+    char* p = buffer;
+    for (; *s != '\0'; s++)
+    {
+        unsigned char c = *s;
+        if (c == '"' || c == '\\')
+        {
+            *p++ = '\\';
+            *p++ = c;
+        }
+        else if (c < 0x20 || c >= 0x7F)
+        {
+            p += sprintf(p, json ? "\\u%04x" : "\\x%02x", c);
+        }
+        else
+        {
+            *p++ = c;
+        }
+    }
+    *p = '\0';
+    return p - buffer;
+}
+
+/**
+ * Evicts entry from cache, freeing it once no connection is still sending it.
+ */
+void evict(struct entry* e)
+{
+    // remove entry from its bucket
+    struct entry** p = &buckets[e->hash & (nbuckets - 1)];
+    while (*p != e)
+    {
+        p = &(*p)->chain;
+    }
+    *p = e->chain;
+    entries--;
+
+    // remove entry from list
+    if (e->hotter != NULL)
+    {
+        e->hotter->colder = e->colder;
+    }
+    else
+    {
+        hottest = e->colder;
+    }
+    if (e->colder != NULL)
+    {
+        e->colder->hotter = e->hotter;
+    }
+    else
+    {
+        coldest = e->hotter;
+    }
+
+    // give back entry's share of budget
+    used -= sizeof(struct entry) + strlen(e->path) + 1;
+    for (int i = 0; i < CODINGS; i++)
+    {
+        if (e->headers[i] != NULL)
+        {
+            used -= e->length[i] + strlen(e->headers[i]) + 1;
+        }
+    }
+    e->cached = false;
+    release(e);
+}
+
+/**
+ * Queues connection's next part of a 206 response (preceded, if multipart, by that
+ * part's headers, else, if no ranges remain, by closing delimiter), whereafter entry's
+ * body or file is to be sent from part's range. Returns true iff successful.
+ */
+bool excerpt(struct connection* c)
+{
+    // queue part's headers (or closing delimiter)
+    if (c->parts > 1)
+    {
+        int n = delimit(NULL, 0, c, c->part);
+        if (n < 0 || !grow(c, n + 1))
+        {
+            return false;
+        }
+        delimit(c->response + c->size, n + 1, c, c->part);
+        c->size += n;
+    }
+
+    // position entry's body or file at part's range, if any
+    off_t first = 0, length = 0;
+    if (c->part < c->parts)
+    {
+        first = c->ranges[c->part].first;
+        length = c->ranges[c->part].last - first + 1;
+    }
+    if (c->entry != NULL)
+    {
+        c->body = c->entry->body[c->coding] + first;
+        c->extent = length;
+    }
+    else if (c->file != -1)
+    {
+        c->offset = first;
+        c->remaining = length;
+    }
+    c->part++;
+    return true;
+}
+
+/**
+ * Turns timer wheel through every slot that's come due since last turned, closing
+ * connections that have passed their deadlines. Returns number of milliseconds until
+ * next slot with deadlines will be due, else -1 if no connection has a deadline.
+ */
+int expire(void)
+{
+    if (timed == 0)
+    {
+        return -1;
+    }
+
+    // close connections whose deadlines have passed, through current slot (which
+    // is turned through again next time, since it's yet to pass in full), rescanning
+    // slot after each, since hanging up an HTTP/2 connection hangs up its streams too
+    long t = now();
+    for (; ; ticked++)
+    {
+        struct connection* c = wheel[ticked % SLOTS];
+        while (c != NULL)
+        {
+            if (c->deadline <= t)
+            {
+                tally(&meter->expired, 1);
+                hangup(c);
+                c = wheel[ticked % SLOTS];
+            }
+            else
+            {
+                c = c->later;
+            }
+        }
+        if (ticked == t / TICK)
+        {
+            break;
+        }
+    }
+
+    // find next slot with deadlines, if any remain, waking at its end
+    for (long slot = ticked; timed > 0; slot++)
+    {
+        if (wheel[slot % SLOTS] != NULL)
+        {
+            return (slot + 1) * TICK - t;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Extends MIME types with those in a file (in the format of Apache's mime.types)
+ * at path, which take precedence over built-in types. Returns true iff successful.
+ */
+bool extend(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    // parse lines of types, each followed by extensions
+    char line[BYTES * 2];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char* comment = strchr(line, '#');
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+        char* type = strtok(line, " \t\r\n");
+        if (type == NULL)
+        {
+            continue;
+        }
+        for (char* extension = strtok(NULL, " \t\r\n"); extension != NULL; extension = strtok(NULL, " \t\r\n"))
+        {
+            // skip extensions too long for lookup to consider
+            if (strlen(extension) > MIME_EXTENSION_MAX)
+            {
+                continue;
+            }
+            for (char* p = extension; *p != '\0'; p++)
+            {
+                *p = tolower((unsigned char) *p);
+            }
+
+            // grow table as needed, so that it's at most half full
+            if ((loaded + 1) * 2 > slots)
+            {
+                size_t m = (slots == 0) ? 256 : slots * 2;
+                char** e = calloc(m, sizeof(char*));
+                char** y = calloc(m, sizeof(char*));
+                if (e == NULL || y == NULL)
+                {
+                    free(e);
+                    free(y);
+                    fclose(file);
+                    return false;
+                }
+                for (size_t i = 0; i < slots; i++)
+                {
+                    if (extensions[i] != NULL)
+                    {
+                        size_t j = mimehash(extensions[i], 0) & (m - 1);
+                        while (e[j] != NULL)
+                        {
+                            j = (j + 1) & (m - 1);
+                        }
+                        e[j] = extensions[i];
+                        y[j] = types[i];
+                    }
+                }
+                free(extensions);
+                free(types);
+                extensions = e;
+                types = y;
+                slots = m;
+            }
+
+            // insert extension, unless already present, in which case first type wins
+            size_t i = mimehash(extension, 0) & (slots - 1);
+            while (extensions[i] != NULL && strcmp(extensions[i], extension) != 0)
+            {
+                i = (i + 1) & (slots - 1);
+            }
+            if (extensions[i] != NULL)
+            {
+                continue;
+            }
+            if ((extensions[i] = strdup(extension)) == NULL || (types[i] = strdup(type)) == NULL)
+            {
+                fclose(file);
+                return false;
+            }
+            loaded++;
+        }
+    }
+    fclose(file);
+
+    // announce types
+    printf("\033[33m");
+    printf("Using %zu MIME types from %s", loaded, path);
+    printf("\033[39m\n");
+    return true;
+}
+
+/**
+ * Handles backend's failure, retrying request on a new connection if backend was
+ * reused (and so might have been closed by peer while idle) and hadn't yet responded,
+ * else responding to client with 502.
+ */
+void fail(struct backend* b)
+{
+    if (b->reused && !b->responded)
+    {
+        close(b->fd);
+        b->fd = -1;
+        b->sent = 0;
+        b->length = 0;
+        if (dial(b))
+        {
+            relay(b);
+            return;
+        }
+    }
+    conclude(b, false);
+}
+
+/**
+ * Finds first occurrence of c among the n bytes at s, comparing 32 (with AVX2)
+ * or 16 (with SSE2) bytes at a time. Returns pointer thereto, else NULL.
+ */
+const char* find(const char* s, size_t n, char c)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256i needles = _mm256_set1_epi8(c);
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i haystack = _mm256_loadu_si256((const __m256i*) (s + i));
+        unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(haystack, needles));
+        if (mask != 0)
+        {
+            return s + i + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i needle = _mm_set1_epi8(c);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i haystack = _mm_loadu_si128((const __m128i*) (s + i));
+        unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(haystack, needle));
+        if (mask != 0)
+        {
+            return s + i + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; i < n; i++)
+    {
+        if (s[i] == c)
+        {
+            return s + i;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Writes (without blocking) as much of connection's response (and then any cached
+ * entry's body or file following it, part by part if multipart) as its socket will
+ * accept, gathering response and entry's body into a single write. Returns true iff
+ * all has been written.
+ */
+bool flush(struct connection* c)
+{
+    // let streams frame their responses instead
+    if (c->parent != NULL)
+    {
+        return frame(c);
+    }
+    while (true)
+    {
+        size_t total = c->size + ((c->entry != NULL) ? c->extent : 0);
+        while (c->sent < total)
+        {
+            // gather whatever remains of response and of entry's body
+            struct iovec iov[2];
+            int n = 0;
+            if (c->sent < c->size)
+            {
+                iov[n].iov_base = c->response + c->sent;
+                iov[n].iov_len = c->size - c->sent;
+                n++;
+            }
+            if (c->entry != NULL)
+            {
+                size_t offset = (c->sent > c->size) ? c->sent - c->size : 0;
+                iov[n].iov_base = (BYTE*) c->body + offset;
+                iov[n].iov_len = c->extent - offset;
+                n++;
+            }
+
+            // if a file is to follow, let kernel hold headers back so that
+            // they share a segment with file's start
+            int flags = 0;
+#ifdef MSG_MORE
+            if (c->file != -1 && c->remaining > 0)
+            {
+                flags |= MSG_MORE;
+            }
+#endif
+            ssize_t bytes = push(c, iov, n, flags);
+            if (bytes == -1)
+            {
+                // wait for socket to become writable again
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    return false;
+                }
+
+                // retry if interrupted, else give up on client
+                if (errno != EINTR)
+                {
+                    c->state = CLOSING;
+                    return false;
+                }
+                continue;
+            }
+            c->sent += bytes;
+            c->written += bytes;
+            tally(&meter->sent, bytes);
+        }
+
+        // send whatever follows response, then move on to next part of a
+        // multipart/byteranges response, if any remains
+        if (!forward(c))
+        {
+            return false;
+        }
+        if (c->parts <= 1 || c->part > c->parts)
+        {
+            return true;
+        }
+        c->size = 0;
+        c->sent = 0;
+        if (!excerpt(c))
+        {
+            c->state = CLOSING;
+            return false;
+        }
+    }
+}
+
+/**
+ * Frees route, unless cache holds it.
+ */
+void forget(struct route* r)
+{
+    if (r != NULL && !r->cached)
+    {
+        free(r->path);
+        free(r->file);
+        free(r);
+    }
+}
+
+/**
+ * Sends (without blocking) as much of connection's file as its socket will accept,
+ * copying from page cache to socket within kernel where possible. Returns true iff
+ * all of file has been sent (or there's no file).
+ */
+bool forward(struct connection* c)
+{
+    while (c->file != -1 && c->remaining > 0)
+    {
+        // send straight from page cache (via kernel's TLS, if connection's over TLS,
+        // else not at all, unless kernel's taken over encryption)
+        ssize_t bytes = -1;
+        errno = ENOSYS;
+#ifdef __linux__
+        if (c->ssl == NULL)
+        {
+            bytes = sendfile(c->fd, c->file, &c->offset, c->remaining);
+        }
+        else if (BIO_get_ktls_send(SSL_get_wbio(c->ssl)))
+        {
+            ERR_clear_error();
+            bytes = SSL_sendfile(c->ssl, c->file, c->offset, c->remaining, 0);
+            if (bytes > 0)
+            {
+                c->offset += bytes;
+            }
+            else
+            {
+                bytes = translate(c, bytes);
+            }
+        }
+#endif
+        if (bytes == -1 && (errno == EINVAL || errno == ENOSYS))
+        {
+            // fall back to copying through a constant-size buffer, resuming at offset
+            // next time if socket accepts only some of it
+            BYTE buffer[BYTES * 16];
+            size_t n = (c->remaining < (off_t) sizeof(buffer)) ? c->remaining : sizeof(buffer);
+            bytes = pread(c->file, buffer, n, c->offset);
+            if (bytes > 0)
+            {
+                struct iovec iov = {buffer, bytes};
+                bytes = push(c, &iov, 1, 0);
+                if (bytes > 0)
+                {
+                    c->offset += bytes;
+                }
+            }
+            else if (bytes == 0)
+            {
+                // file was truncated, so response can't be completed
+                errno = EIO;
+                bytes = -1;
+            }
+        }
+        if (bytes == -1)
+        {
+            // wait for socket to become writable again
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return false;
+            }
+
+            // retry if interrupted, else give up on client
+            if (errno != EINTR)
+            {
+                c->state = CLOSING;
+                return false;
+            }
+            continue;
+        }
+        c->remaining -= bytes;
+        c->written += bytes;
+        tally(&meter->sent, bytes);
+    }
+    return true;
+}
+
+/**
+ * Frames as much of stream's response as HTTP/2 connection's and stream's windows
+ * allow: its headers (just once), as HTTP/1.1's translated into a HEADERS frame (and
+ * any CONTINUATIONs), then whatever's to follow them (as flush would send it) in DATA
+ * frames, the last of which ends stream, once response is complete. Frames are queued
+ * on connection, which is written to whenever QUEUE bytes are queued (and once stream
+ * is done, unless connection is handling frames, and so will write them itself).
+ * Returns true iff all of response thus far has been framed.
+ * https://tools.ietf.org/html/rfc7540#section-8.1
+ */
+bool frame(struct connection* c)
+{
+    struct connection* p = c->parent;
+    struct session* s = p->session;
+    if (p->state == CLOSING)
+    {
+        c->state = CLOSING;
+        return false;
+    }
+
+    // translate response's headers, which begin response, once there (as they
+    // mightn't be yet, if a backend is still to produce them)
+    if (!c->headed)
+    {
+        const BYTE* end = memmem(c->response, c->size, "\r\n\r\n", 4);
+        if (end == NULL && c->state == WAITING)
+        {
+            return true;
+        }
+        if (end == NULL)
+        {
+            c->state = CLOSING;
+            return false;
+        }
+        size_t n = end + 4 - c->response;
+        BYTE block[n * 2 + 8];
+        size_t m = pack(c->response, n, block);
+        c->sent = n;
+        c->headed = true;
+
+        // end stream with headers if nothing's to follow them
+        bool last = (c->state == WRITING && c->size == n && (c->entry == NULL || c->extent == 0)
+            && (c->file == -1 || c->remaining == 0) && (c->parts <= 1 || c->part > c->parts));
+        for (size_t i = 0; i == 0 || i < m; i += FRAME)
+        {
+            size_t k = (m - i < FRAME) ? m - i : FRAME;
+            int flags = ((i + k == m) ? HTTP2_END_HEADERS : 0) | ((i == 0 && last) ? HTTP2_END_STREAM : 0);
+            if (!post(p, (i == 0) ? HTTP2_HEADERS : HTTP2_CONTINUATION, flags, c->id, block + i, k))
+            {
+                c->state = CLOSING;
+                return false;
+            }
+            c->written += 9 + k;
+        }
+        c->ended = last;
+    }
+
+    // frame rest of response, then entry's body or file, then next part (if multipart)
+    BYTE buffer[FRAME];
+    bool framed = true;
+    while (true)
+    {
+        const BYTE* data = NULL;
+        size_t available = 0;
+        size_t offset = (c->sent > c->size) ? c->sent - c->size : 0;
+        if (c->sent < c->size)
+        {
+            data = c->response + c->sent;
+            available = c->size - c->sent;
+        }
+        else if (c->entry != NULL && offset < c->extent)
+        {
+            data = c->body + offset;
+            available = c->extent - offset;
+        }
+        else if (c->file != -1 && c->remaining > 0)
+        {
+            available = (c->remaining < FRAME) ? c->remaining : FRAME;
+        }
+        else if (c->parts > 1 && c->part <= c->parts)
+        {
+            c->size = 0;
+            c->sent = 0;
+            if (!excerpt(c))
+            {
+                c->state = CLOSING;
+                return false;
+            }
+            continue;
+        }
+        else
+        {
+            break;
+        }
+
+        // wait for windows to open, or (if QUEUE bytes are queued) for socket to accept some
+        long room = (s->window < c->window) ? s->window : c->window;
+        if (room <= 0 || (p->size - p->sent >= QUEUE && !transmit(p)))
+        {
+            framed = false;
+            break;
+        }
+        size_t n = (available < (size_t) room) ? available : (size_t) room;
+        n = (n < FRAME) ? n : FRAME;
+
+        // read file's next bytes, unless data's in memory
+        if (data == NULL)
+        {
+            ssize_t bytes = pread(c->file, buffer, n, c->offset);
+            if (bytes == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (bytes <= 0)
+            {
+                c->state = CLOSING;
+                return false;
+            }
+            n = bytes;
+            data = buffer;
+        }
+
+        // end stream with last of response
+        off_t left = (c->size - ((c->sent < c->size) ? c->sent : c->size))
+            + ((c->entry != NULL) ? c->extent - offset : 0) + ((c->file != -1) ? c->remaining : 0);
+        bool last = (c->state == WRITING && (off_t) n == left && (c->parts <= 1 || c->part > c->parts));
+        if (!post(p, HTTP2_DATA, last ? HTTP2_END_STREAM : 0, c->id, data, n))
+        {
+            c->state = CLOSING;
+            return false;
+        }
+        if (data == buffer)
+        {
+            c->offset += n;
+            c->remaining -= n;
+        }
+        else
+        {
+            c->sent += n;
+        }
+        s->window -= n;
+        c->window -= n;
+        c->written += 9 + n;
+        c->ended = last;
+    }
+
+    // end stream once response is complete, if its last frame didn't
+    if (framed && c->state == WRITING && !c->ended)
+    {
+        if (!post(p, HTTP2_DATA, HTTP2_END_STREAM, c->id, NULL, 0))
+        {
+            c->state = CLOSING;
+            return false;
+        }
+        c->written += 9;
+        c->ended = true;
+    }
+    if (!s->handling)
+    {
+        transmit(p);
+    }
+    if (p->state == CLOSING)
+    {
+        c->state = CLOSING;
+        return false;
+    }
+    return framed;
+}
+
+/**
+ * Frees memory allocated by scandir.
+ */
+void freedir(struct dirent** namelist, int n)
+{
+    if (namelist != NULL)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            free(namelist[i]);
+        }
+        free(namelist);
+    }
+}
+ 
+/**
+ * Snapshots directory recursively, preserving each of its entries (without following
+ * symbolic links to directories) and then directory itself, both as directory and
+ * as directory/. Returns true iff successful.
+ */
+bool freeze(const char* directory)
+{
+    // read directory's entries
+    struct dirent** namelist = NULL;
+    int n = scandir(directory, &namelist, NULL, NULL);
+    if (n == -1)
+    {
+        return false;
+    }
+
+    // preserve each entry, descending into subdirectories
+    bool ok = true;
+    for (int i = 0; i < n && ok; i++)
+    {
+        if (strcmp(namelist[i]->d_name, ".") == 0 || strcmp(namelist[i]->d_name, "..") == 0)
+        {
+            continue;
+        }
+        char path[strlen(directory) + 1 + strlen(namelist[i]->d_name) + 1];
+        sprintf(path, "%s/%s", directory, namelist[i]->d_name);
+        struct stat sb;
+        ok = (lstat(path, &sb) == 0) && (S_ISDIR(sb.st_mode) ? freeze(path) : preserve(path));
+    }
+    freedir(namelist, n);
+
+    // preserve directory itself
+    char path[strlen(directory) + 1 + 1];
+    sprintf(path, "%s/", directory);
+    return ok && preserve(directory) && preserve(path);
+}
+
+/**
+ * Determines whether client's copy of a representation, whose entity-tag is etag and
+ * which was last modified at mtime, is still fresh, per If-None-Match (compared weakly)
+ * or, absent that, If-Modified-Since. Returns true iff so (i.e., 304 is to be sent).
+ * https://tools.ietf.org/html/rfc7232#section-6
+ */
+bool fresh(const char* etag, time_t mtime)
+{
+    size_t n;
+    const char* value = header(client, "If-None-Match", &n);
+    if (value != NULL)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            if (value[i] == '*')
+            {
+                return true;
+            }
+
+            // compare opaque-tag (including its quotes), ignoring any W/ before it
+            if (value[i] == '"')
+            {
+                const char* end = find(value + i + 1, n - i - 1, '"');
+                if (end == NULL)
+                {
+                    return false;
+                }
+                size_t length = end - (value + i) + 1;
+                if (length == strlen(etag) && strncmp(value + i, etag, length) == 0)
+                {
+                    return true;
+                }
+                i = end - value;
+            }
+        }
+        return false;
+    }
+    value = header(client, "If-Modified-Since", &n);
+    time_t since = (value != NULL) ? when(value, n) : -1;
+    return since != -1 && mtime <= since;
+}
+
+/**
+ * Ensures connection's response has room for n more bytes, doubling buffer's
+ * capacity as needed. Returns true iff successful.
+ */
+bool grow(struct connection* c, size_t n)
+{
+    if (c->size + n > c->capacity)
+    {
+        size_t m = (c->capacity == 0) ? BUFFER : c->capacity;
+        while (c->size + n > m)
+        {
+            m *= 2;
+        }
+        BYTE* response = realloc(c->response, m);
+        if (response == NULL)
+        {
+            return false;
+        }
+        c->response = response;
+        c->capacity = m;
+    }
+    return true;
+}
+
+/**
+ * Handles signals.
+ */
+void handler(int signal)
+{
+    // control-c
+    if (signal == SIGINT)
+    {
+        signaled = true;
+    }
+
+    // graceful stop, reload, and upgrade
+    else if (signal == SIGQUIT)
+    {
+        quitting = true;
+    }
+    else if (signal == SIGHUP)
+    {
+        reloading = true;
+    }
+    else if (signal == SIGUSR2)
+    {
+        upgrading = true;
+    }
+}
+
+/**
+ * Closes connection, deferring its deallocation until event loop
+ * has handled any other events already reported for it.
+ */
+void hangup(struct connection* c)
+{
+    // hang up HTTP/2 connection's streams first
+    if (c->session != NULL)
+    {
+        c->state = CLOSING;
+        while (c->session->streams != NULL)
+        {
+            hangup(c->session->streams);
+        }
+    }
+
+    // reset stream unless it's ended (or its connection is closing), then forget it,
+    // leaving connection's socket open
+    if (c->parent != NULL)
+    {
+        struct session* s = c->parent->session;
+        if (!c->ended && c->parent->state != CLOSING && notify(c->parent, HTTP2_RST_STREAM, c->id, HTTP2_CANCEL)
+            && !s->handling)
+        {
+            transmit(c->parent);
+        }
+        for (struct connection** p = &s->streams; *p != NULL; p = &(*p)->sibling)
+        {
+            if (*p == c)
+            {
+                *p = c->sibling;
+                break;
+            }
+        }
+        s->nstreams--;
+        c->fd = -1;
+    }
+
+    // close client's socket, which also stops watching it, after ending TLS connection,
+    // if any (as best as can be without blocking)
+    else if (c->fd != -1)
+    {
+        if (c->ssl != NULL)
+        {
+            ERR_clear_error();
+            if (SSL_is_init_finished(c->ssl))
+            {
+                SSL_shutdown(c->ssl);
+            }
+            SSL_free(c->ssl);
+            c->ssl = NULL;
+        }
+        close(c->fd);
+        c->fd = -1;
+        tally(&meter->connections, -1);
+        connections--;
+        dismiss(c->address);
+    }
+
+    // abandon request relayed to backend, if any
+    if (c->backend != NULL)
+    {
+        detach(c->backend, false);
+    }
+
+    // abandon job, if any, to be discarded once complete
+    if (c->job != NULL)
+    {
+        c->job->client = NULL;
+        c->job = NULL;
+    }
+
+    // forget connection's deadline
+    timeout(c, 0);
+
+    // discard request and response, keeping their buffers for connection's reuse
+    c->size = 0;
+    c->sent = 0;
+    if (c->entry != NULL)
+    {
+        release(c->entry);
+        c->entry = NULL;
+    }
+    if (c->file != -1)
+    {
+        close(c->file);
+        c->file = -1;
+    }
+    c->ranges = NULL;
+    reclaim(c);
+
+    // retire connection later
+    c->next = closed;
+    closed = c;
+}
+
+/**
+ * Hashes string (with djb2).
+ */
+unsigned long hash(const char* s)
+{
+    unsigned long h = 5381;
+    for (const unsigned char* p = (const unsigned char*) s; *p != '\0'; p++)
+    {
+        h = h * 33 + *p;
+    }
+    return h;
+}
+
+/**
+ * Looks up header field with name (case-insensitively) among connection's request's
+ * parsed headers. Returns pointer to field's value (which isn't nul-terminated),
+ * storing value's length in *length, else NULL.
+ */
+const char* header(const struct connection* c, const char* name, size_t* length)
+{
+    size_t n = strlen(name);
+    for (int i = 0; i < c->parsed.fields; i++)
+    {
+        const struct slice* s = &c->parsed.names[i];
+        if (s->length == n && strncasecmp(c->message + s->start, name, n) == 0)
+        {
+            *length = c->parsed.values[i].length;
+            return c->message + c->parsed.values[i].start;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Escapes n bytes of s for HTML into t, which must have room for them even if every
+ * one is escaped (i.e., 6 bytes per byte, plus 1), in a single pass that copies runs
+ * of bytes needing no escape whole. Returns escaped string's length.
+ */
+size_t htmlspecialchars(const char* s, size_t n, char* t)
+{
+    char* p = t;
+    for (size_t i = 0; i < n; )
+    {
+        const char* entity;
+        switch (s[i])
+        {
+            case '&': entity = "&amp;"; break;
+            case '"': entity = "&quot;"; break;
+            case '\'': entity = "&#039;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+
+            // copy run of characters that needn't be escaped
+            default:
+            {
+                const char* special = scan(s + i + 1, n - i - 1, "&\"'<>");
+                size_t run = (special != NULL) ? special - (s + i) : n - i;
+                memcpy(p, s + i, run);
+                p += run;
+                i += run;
+                continue;
+            }
+        }
+        size_t m = strlen(entity);
+        memcpy(p, entity, m);
+        p += m;
+        i++;
+    }
+    *p = '\0';
+
+    // escaped string's length
+    return p - t;
+}
+
+/**
+ * Decodes n bytes of Huffman-encoded s into t, which has room for size bytes. Since
+ * HPACK's code is canonical (its codes of each width being consecutive, the first
+ * of each following on from the last of the width before), codes are derived once
+ * from their widths alone. Returns decoded length, else -1 if invalid (or too long).
+ * https://tools.ietf.org/html/rfc7541#section-5.2
+ */
+long huffman(const unsigned char* s, size_t n, char* t, size_t size)
+{
+    // first code of each width, number of codes thereof, and index of that first
+    // code's symbol among symbols sorted by code
+    static unsigned int firsts[32];
+    static unsigned int counts[32];
+    static unsigned int offsets[32];
+    static unsigned short symbols[257];
+    if (counts[5] == 0)
+    {
+        for (int i = 0; i < 257; i++)
+        {
+            counts[widths[i]]++;
+        }
+        unsigned int code = 0, offset = 0, placed[32] = {0};
+        for (int width = 1; width < 32; width++)
+        {
+            firsts[width] = code;
+            offsets[width] = offset;
+            offset += counts[width];
+            code = (code + counts[width]) << 1;
+        }
+        for (int i = 0; i < 257; i++)
+        {
+            symbols[offsets[widths[i]] + placed[widths[i]]++] = i;
+        }
+    }
+
+    // decode bit by bit, until bits thus far are a code
+    size_t m = 0;
+    unsigned int code = 0;
+    int width = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        for (int bit = 7; bit >= 0; bit--)
+        {
+            code = (code << 1) | ((s[i] >> bit) & 1);
+            width++;
+            if (code - firsts[width] < counts[width])
+            {
+                unsigned int symbol = symbols[offsets[width] + code - firsts[width]];
+                if (symbol == 256 || m == size)
+                {
+                    return -1;
+                }
+                t[m++] = symbol;
+                code = 0;
+                width = 0;
+            }
+            else if (width == 30)
+            {
+                return -1;
+            }
+        }
+    }
+
+    // ensure padding is fewer than 8 bits, all 1s (i.e., the start of EOS's code)
+    if (width > 7 || code != (1u << width) - 1)
+    {
+        return -1;
+    }
+    return m;
+}
+
+/**
+ * Identifies request's span in note, for tracing: continues trace whose ID (and
+ * parent span's) are in value (n bytes long) of request's traceparent header, if
+ * valid, else starts a new trace, span's own ID being new either way.
+ * https://www.w3.org/TR/trace-context/#traceparent-header
+ */
+void identify(struct note* note, const char* value, size_t n)
+{
+    // generate IDs (in hex) for a new trace and span, leaving them empty if none can be
+    unsigned char bytes[24];
+    char id[sizeof(bytes) * 2 + 1] = "";
+    if (RAND_bytes(bytes, sizeof(bytes)) == 1)
+    {
+        for (size_t i = 0; i < sizeof(bytes); i++)
+        {
+            id[i * 2] = "0123456789abcdef"[bytes[i] >> 4];
+            id[i * 2 + 1] = "0123456789abcdef"[bytes[i] & 0xf];
+        }
+        id[sizeof(bytes) * 2] = '\0';
+    }
+
+    // validate traceparent (e.g., 00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01),
+    // whose version 00 is exactly 55 bytes long, future versions possibly longer
+    bool valid = (value != NULL) && (n == 55 || (n > 55 && value[55] == '-' && strncmp(value, "00", 2) != 0))
+        && strncmp(value, "ff", 2) != 0;
+    for (size_t i = 0; i < 55 && valid; i++)
+    {
+        valid = (i == 2 || i == 35 || i == 52) ? (value[i] == '-')
+            : (isxdigit((unsigned char) value[i]) && !isupper((unsigned char) value[i]));
+    }
+    valid = valid && strspn(value + 3, "0") < 32 && strspn(value + 36, "0") < 16;
+
+    // continue trace, if valid, else start one
+    if (valid)
+    {
+        clip(note->trace, sizeof(note->trace), value + 3, 32);
+        clip(note->parent, sizeof(note->parent), value + 36, 16);
+    }
+    else
+    {
+        clip(note->trace, sizeof(note->trace), id, (id[0] != '\0') ? 32 : 0);
+        note->parent[0] = '\0';
+    }
+    clip(note->span, sizeof(note->span), id + 32, (id[0] != '\0') ? 16 : 0);
+}
+
+/**
+ * Checks, in order, whether index.php or index.html exists inside of path.
+ * Returns path to first match if so, else NULL.
+ */
+char* indexes(const char* path)
+{
+    // path/index.php, else path/index.html, whichever exists
+    char* index = malloc(strlen(path) + strlen("/index.html") + 1);
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    const char* slash = (path[0] != '\0' && path[strlen(path) - 1] == '/') ? "" : "/";
+    sprintf(index, "%s%sindex.php", path, slash);
+    if (access(index, F_OK) == 0)
+    {
+        return index;
+    }
+    sprintf(index, "%s%sindex.html", path, slash);
+    if (access(index, F_OK) == 0)
+    {
+        return index;
+    }
+    free(index);
+    return NULL;
+}
+
+/**
+ * Takes a socket handed down by predecessor for address, if any, announcing it
+ * (as listener would) if announce. Returns socket, else -1.
+ */
+int inherit(const char* address, bool announce)
+{
+    for (int i = 0; i < ninherited; i++)
+    {
+        if (inherited[i].fd != -1 && strcmp(inherited[i].address, address) == 0)
+        {
+            int fd = inherited[i].fd;
+            inherited[i].fd = -1;
+            if (announce)
+            {
+                printf("\033[33m");
+                printf("Listening on %s (inherited)", address);
+                printf("\033[39m\n");
+            }
+            return fd;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Decodes HPACK integer with an n-bit prefix at *p (before end), storing it in *value
+ * and advancing *p past it. Returns true iff valid (and less than 2^28 or so).
+ * https://tools.ietf.org/html/rfc7541#section-5.1
+ */
+bool integer(const unsigned char** p, const unsigned char* end, int n, size_t* value)
+{
+    if (*p == end)
+    {
+        return false;
+    }
+    size_t max = (1 << n) - 1;
+    *value = *(*p)++ & max;
+    if (*value < max)
+    {
+        return true;
+    }
+    for (int shift = 0; shift <= 21; shift += 7)
+    {
+        if (*p == end)
+        {
+            return false;
+        }
+        unsigned char b = *(*p)++;
+        *value += (size_t) (b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Interprets PHP file at path using query string, relaying request to FastCGI backend,
+ * which is to respond to client asynchronously.
+ */
+void interpret(const char* path, const char* query)
+{
+    // ensure path is readable
+    if (access(path, R_OK) == -1)
+    {
+        error(403);
+        return;
+    }
+
+    // meta-variables whereby script learns of request
+    // https://tools.ietf.org/html/rfc3875#section-4.1
+    const char* names[] = {"DOCUMENT_ROOT", "GATEWAY_INTERFACE", "HTTPS", "QUERY_STRING", "REDIRECT_STATUS",
+        "REQUEST_METHOD", "SCRIPT_FILENAME", "SCRIPT_NAME", "SERVER_PROTOCOL", "SERVER_SOFTWARE"};
+    const char* values[] = {root, "CGI/1.1", (tls != NULL) ? "on" : "", query, "200", "GET", path,
+        path + strlen(root), "HTTP/1.1", "WebServerC"};
+    size_t n = sizeof(names) / sizeof(names[0]);
+
+    // measure meta-variables, including one (prefixed with HTTP_) per header field
+    size_t length = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        length += pair(NULL, names[i], strlen(names[i]), values[i], strlen(values[i]));
+    }
+    for (int i = 0; i < client->parsed.fields; i++)
+    {
+        length += pair(NULL, "", strlen("HTTP_") + client->parsed.names[i].length, "",
+            client->parsed.values[i].length);
+    }
+
+    // encode meta-variables
+    BYTE params[length];
+    length = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        length += pair(params + length, names[i], strlen(names[i]), values[i], strlen(values[i]));
+    }
+    for (int i = 0; i < client->parsed.fields; i++)
+    {
+        // transform header field's name into meta-variable's
+        const struct slice* s = &client->parsed.names[i];
+        char name[strlen("HTTP_") + s->length + 1];
+        strcpy(name, "HTTP_");
+        for (int j = 0; j < s->length; j++)
+        {
+            char ch = client->message[s->start + j];
+            name[strlen("HTTP_") + j] = (ch == '-') ? '_' : toupper((unsigned char) ch);
+        }
+        name[strlen("HTTP_") + s->length] = '\0';
+        length += pair(params + length, name, strlen(name),
+            client->message + client->parsed.values[i].start, client->parsed.values[i].length);
+    }
+
+    // connect to backend
+    struct backend* b = acquire();
+    if (b == NULL)
+    {
+        error(502);
+        return;
+    }
+
+    // encode request as records, with parameters followed by (empty) stdin
+    unsigned char begin[8] = {0, FCGI_RESPONDER, FCGI_KEEP_CONN, 0, 0, 0, 0, 0};
+    if (!record(b, FCGI_BEGIN_REQUEST, (BYTE*) begin, sizeof(begin))
+        || !record(b, FCGI_PARAMS, params, length) || !record(b, FCGI_PARAMS, NULL, 0)
+        || !record(b, FCGI_STDIN, NULL, 0))
+    {
+        detach(b, false);
+        error(500);
+        return;
+    }
+
+    // relay request to backend
+    b->client = client;
+    b->began = nanotime();
+    client->backend = b;
+    relay(b);
+}
+
+/**
+ * Reads (without blocking) inotify's events, evicting from cache entries whose
+ * files (or ancestors thereof) have changed.
+ */
+void invalidate(void)
+{
+#ifdef __linux__
+    _Alignas(struct inotify_event) char buffer[BYTES * 8];
+    while (true)
+    {
+        ssize_t bytes = read(ifd, buffer, sizeof(buffer));
+        if (bytes == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            return;
+        }
+
+        // iterate over events
+        for (char* p = buffer; p < buffer + bytes; )
+        {
+            struct inotify_event* event = (struct inotify_event*) p;
+            p += sizeof(struct inotify_event) + event->len;
+
+            // if events were lost, evict everything
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                purge(NULL);
+                unroute(NULL, true);
+                continue;
+            }
+
+            // find watch's directory
+            size_t i = 0;
+            while (i < watches && wds[i] != event->wd)
+            {
+                i++;
+            }
+            if (i == watches)
+            {
+                continue;
+            }
+
+            // if directory itself changed, evict everything beneath it
+            if (event->len == 0 || (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)))
+            {
+                char prefix[strlen(directories[i]) + 1 + 1];
+                sprintf(prefix, "%s/", directories[i]);
+                purge(prefix);
+                unroute(prefix, true);
+
+                // forget watch that inotify has removed
+                if (event->mask & IN_IGNORED)
+                {
+                    free(directories[i]);
+                    watches--;
+                    wds[i] = wds[watches];
+                    directories[i] = directories[watches];
+                }
+
+                // remove watches of directory that moved (and of directories beneath it),
+                // since they'd otherwise report changes under directory's old path,
+                // to be watched anew under its new path
+                else if (event->mask & IN_MOVE_SELF)
+                {
+                    prefix[strlen(prefix) - 1] = '\0';
+                    for (size_t j = 0; j < watches; )
+                    {
+                        if (strcmp(directories[j], prefix) == 0
+                            || (strncmp(directories[j], prefix, strlen(prefix)) == 0
+                                && directories[j][strlen(prefix)] == '/'))
+                        {
+                            inotify_rm_watch(ifd, wds[j]);
+                            free(directories[j]);
+                            watches--;
+                            wds[j] = wds[watches];
+                            directories[j] = directories[watches];
+                        }
+                        else
+                        {
+                            j++;
+                        }
+                    }
+                }
+                continue;
+            }
+
+            // evict entry for file that changed, else everything
+            // beneath directory that changed
+            char path[strlen(directories[i]) + 1 + strlen(event->name) + 1 + 1];
+            sprintf(path, "%s/%s", directories[i], event->name);
+            struct entry* e = cached(path);
+            if (e != NULL)
+            {
+                evict(e);
+            }
+
+            // evict entry for file whose precompressed sibling changed, if that's what changed
+            for (int j = IDENTITY + 1; j < CODINGS; j++)
+            {
+                size_t m = strlen(path), o = strlen(suffixes[j]);
+                if (m > o && strcmp(path + m - o, suffixes[j]) == 0)
+                {
+                    path[m - o] = '\0';
+                    if ((e = cached(path)) != NULL)
+                    {
+                        evict(e);
+                    }
+                    path[m - o] = suffixes[j][0];
+                }
+            }
+            if (event->mask & IN_ISDIR)
+            {
+                strcat(path, "/");
+                purge(path);
+                path[strlen(path) - 1] = '\0';
+            }
+
+            // forget how path (and anything beneath it) resolved and, if directory's
+            // entries changed, how directory did (as to an index or listing), along
+            // with directory's listing
+            unroute(path, true);
+            if (event->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO))
+            {
+                path[strlen(directories[i]) + 1] = '\0';
+                unroute(path, false);
+                if ((e = cached(path)) != NULL)
+                {
+                    evict(e);
+                }
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * Jots in ring a note of connection's request, whose response has just been sent
+ * after duration nanoseconds, for access log, unless request isn't sampled or ring
+ * is full, in which case note is dropped (rather than event loop wait).
+ */
+void jot(struct connection* c, long long duration)
+{
+    // log only one in every sampling requests
+    if (notes == NULL || ++sampled < sampling)
+    {
+        return;
+    }
+    sampled = 0;
+
+    // ensure ring has room, which only event loop consumes
+    unsigned long head = jotted;
+    if (head - __atomic_load_n(&scribed, __ATOMIC_ACQUIRE) == NOTES)
+    {
+        tally(&meter->dropped, 1);
+        return;
+    }
+
+    // jot note, then publish it
+    struct note* note = &notes[head & (NOTES - 1)];
+    memcpy(note->address, c->address, sizeof(note->address));
+    note->time = time(NULL);
+    note->code = c->code;
+    note->bytes = c->written;
+    note->duration = duration;
+    memcpy(note->spans, c->spans, sizeof(note->spans));
+    clip(note->request, sizeof(note->request), c->message + c->parsed.request.start, c->parsed.request.length);
+    size_t n = 0;
+    const char* value = header(c, "Referer", &n);
+    clip(note->referer, sizeof(note->referer), (value != NULL) ? value : "", (value != NULL) ? n : 0);
+    value = header(c, "User-Agent", &n);
+    clip(note->agent, sizeof(note->agent), (value != NULL) ? value : "", (value != NULL) ? n : 0);
+    value = header(c, "traceparent", &n);
+    identify(note, value, (value != NULL) ? n : 0);
+    __atomic_store_n(&jotted, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Formats in buffer (of size bytes) response's headers (other than Content-Length
+ * and Connection) for a body of MIME type type in coding, per snprintf, unless
+ * buffer is NULL, along with validators for (and ranges of) file whose metadata
+ * is sb, unless sb is NULL. Returns length of headers, else a negative value on error.
+ */
+int label(char* buffer, size_t size, const char* type, enum coding coding, const struct stat* sb)
+{
+    // entity-tag and last-modification date by which clients can revalidate
+    // their copies, and with which they can ask for ranges
+    // https://tools.ietf.org/html/rfc7232#section-2
+    char validators[BYTES] = "";
+    if (sb != NULL)
+    {
+        char etag[BYTES / 4];
+        char date[BYTES / 4];
+        struct tm tm;
+        if (tag(etag, sizeof(etag), sb, coding) < 0 || gmtime_r(&sb->st_mtime, &tm) == NULL
+            || strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm) == 0)
+        {
+            return -1;
+        }
+        snprintf(validators, sizeof(validators), "ETag: %s\r\nLast-Modified: %s\r\nAccept-Ranges: bytes\r\n", etag, date);
+    }
+
+    // vary compressible responses by Accept-Encoding, so that caches don't
+    // send one coding to clients that accept only another
+    // https://tools.ietf.org/html/rfc7231#section-7.1.4
+    bool encoded = (coding != IDENTITY);
+    return snprintf(buffer, size, "Content-Type: %s\r\n%s%s%s%s%s", type,
+        encoded ? "Content-Encoding: " : "", encoded ? codings[coding] : "", encoded ? "\r\n" : "",
+        compressible(type) ? "Vary: Accept-Encoding\r\n" : "", validators);
+}
+
+/**
+ * Launches a pool of php-cgi processes, accepting connections on a unix socket
+ * of server's own, for use as FastCGI backend. Returns true iff successful.
+ */
+bool launch(void)
+{
+    // create socket
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "/tmp/server.%i.sock", (int) getpid());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        return false;
+    }
+    unlink(addr.sun_path);
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) == -1 || listen(fd, SOMAXCONN) == -1)
+    {
+        close(fd);
+        return false;
+    }
+    fastcgi = strdup(addr.sun_path);
+    if (fastcgi == NULL)
+    {
+        close(fd);
+        return false;
+    }
+
+    // spawn php-cgi, which (per FastCGI) accepts connections on its stdin,
+    // forking as many children of its own as there are CPUs
+    fflush(stdout);
+    php = fork();
+    if (php == 0)
+    {
+        dup2(fd, STDIN_FILENO);
+        close(fd);
+        char children[16];
+        snprintf(children, sizeof(children), "%li", sysconf(_SC_NPROCESSORS_ONLN));
+        setenv("PHP_FCGI_CHILDREN", children, 1);
+        execlp("php-cgi", "php-cgi", NULL);
+        _exit(127);
+    }
+
+    // close socket in server, so that connections are refused if php-cgi dies
+    close(fd);
+    if (php == -1)
+    {
+        php = 0;
+        return false;
+    }
+
+    // announce pool
+    printf("\033[33m");
+    printf("Using php-cgi on %s for PHP", fastcgi);
+    printf("\033[39m\n");
+    return true;
+}
+
+/**
+ * Responds to client with directory listing of path, rendered in time linear
+ * in directory's number of entries and cached until directory changes.
+ */
+void list(const char* path)
+{
+    // ensure path is readable and executable
+    if (access(path, R_OK | X_OK) == -1)
+    {
+        error(403);
+        return;
+    }
+
+    // remember directory's identity before reading its entries, so that
+    // any change made while they're read invalidates listing
+    struct stat sb;
+    if (stat(path, &sb) == -1)
+    {
+        error(500);
+        return;
+    }
+
+    // read directory's entries, sorted
+    struct dirent** namelist = NULL;
+    int n = scandir(path, &namelist, NULL, alphasort);
+    if (n == -1)
+    {
+        error(500);
+        return;
+    }
+
+    // render listing into a buffer that grows as needed
+    char* list = NULL;
+    size_t length = 0, capacity = 0;
+    // (escaping names into memory that lasts only as long as request)
+    size_t m = strlen(path + strlen(root));
+    char* title = allot(client, m * strlen("&quot;") + 1);
+    m = (title != NULL) ? htmlspecialchars(path + strlen(root), m, title) : 0;
+    bool ok = (title != NULL)
+        && append(&list, &length, &capacity, "<html><head><title>", strlen("<html><head><title>"))
+        && append(&list, &length, &capacity, title, m)
+        && append(&list, &length, &capacity, "</title></head><body><h1>", strlen("</title></head><body><h1>"))
+        && append(&list, &length, &capacity, title, m)
+        && append(&list, &length, &capacity, "</h1><ul>", strlen("</h1><ul>"));
+    char name[sizeof(namelist[0]->d_name) * strlen("&quot;") + 1];
+    for (int i = 0; i < n && ok; i++)
+    {
+        // omit . from list
+        if (strcmp(namelist[i]->d_name, ".") == 0)
+        {
+            continue;
+        }
+
+        // append list item, with entry's name escaped
+        m = htmlspecialchars(namelist[i]->d_name, strlen(namelist[i]->d_name), name);
+        ok = append(&list, &length, &capacity, "<li><a href=\"", strlen("<li><a href=\""))
+            && append(&list, &length, &capacity, name, m)
+            && append(&list, &length, &capacity, "\">", strlen("\">"))
+            && append(&list, &length, &capacity, name, m)
+            && append(&list, &length, &capacity, "</a></li>", strlen("</a></li>"));
+    }
+    ok = ok && append(&list, &length, &capacity, "</ul></body></html>", strlen("</ul></body></html>"));
+
+    // free memory allocated by scandir
+    freedir(namelist, n);
+    if (!ok)
+    {
+        free(list);
+        error(500);
+        return;
+    }
+
+    // cache listing until directory changes, so that later requests needn't re-read it
+    struct entry* e = cache(path, &sb, "text/html", (BYTE*) list, length);
+    if (e != NULL)
+    {
+        deliver(e);
+        return;
+    }
+
+    // respond with list
+    char* headers = "Content-Type: text/html\r\n";
+    respond(200, headers, list, length);
+    free(list);
+}
+
+
+/**
+ * Creates a non-blocking socket listening on address (as given to -l), i.e., on a unix
+ * socket (unix:/path/to/socket, replacing any stale one), else on a port (alone, or
+ * after * or nothing, meaning all addresses, IPv6's and, via dual stack, IPv4's), or
+ * on a port of a host (e.g., 127.0.0.1:8080, localhost:8080, or [::1]:8080), optionally
+ * shared with other sockets bound to the same port, announcing address if asked.
+ * Returns socket, else -1.
+ */
+int listener(const char* address, bool shared, bool announce)
+{
+    struct sockaddr_storage addr;
+    memset(&addr, 0, sizeof(addr));
+    socklen_t addrlen = 0;
+    if (strncmp(address, "unix:", strlen("unix:")) == 0)
+    {
+        // name unix socket
+        struct sockaddr_un* sun = (struct sockaddr_un*) &addr;
+        const char* path = address + strlen("unix:");
+        if (strlen(path) > 0 && strlen(path) < sizeof(sun->sun_path))
+        {
+            sun->sun_family = AF_UNIX;
+            strcpy(sun->sun_path, path);
+            addrlen = sizeof(struct sockaddr_un);
+
+            // remove socket left behind by a server that's gone (i.e., to which
+            // nothing's listening anymore)
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd != -1 && connect(fd, (struct sockaddr*) sun, addrlen) == -1 && errno == ECONNREFUSED)
+            {
+                unlink(path);
+            }
+            if (fd != -1)
+            {
+                close(fd);
+            }
+        }
+    }
+    else
+    {
+        // split address into host (sans brackets) and port
+        const char* colon = strrchr(address, ':');
+        const char* port = (colon != NULL) ? colon + 1 : address;
+        const char* start = address;
+        size_t n = (colon != NULL) ? colon - address : 0;
+        if (n >= 2 && start[0] == '[' && start[n - 1] == ']')
+        {
+            start++;
+            n -= 2;
+        }
+        char host[BYTES] = "";
+        bool valid = (n < sizeof(host) && strlen(port) > 0 && strlen(port) <= 5
+            && strspn(port, "0123456789") == strlen(port) && atoi(port) <= 65535);
+        if (valid)
+        {
+            memcpy(host, start, n);
+            host[n] = '\0';
+        }
+
+        // listen on all addresses via IPv6 (whose sockets accept IPv4 clients too,
+        // as IPv4-mapped addresses), if supported, else via IPv4
+        if (valid && (n == 0 || strcmp(host, "*") == 0))
+        {
+            int fd = socket(AF_INET6, SOCK_STREAM, 0);
+            if (fd != -1)
+            {
+                close(fd);
+                struct sockaddr_in6* sin6 = (struct sockaddr_in6*) &addr;
+                sin6->sin6_family = AF_INET6;
+                sin6->sin6_port = htons(atoi(port));
+                sin6->sin6_addr = in6addr_any;
+                addrlen = sizeof(struct sockaddr_in6);
+            }
+            else
+            {
+                struct sockaddr_in* sin = (struct sockaddr_in*) &addr;
+                sin->sin_family = AF_INET;
+                sin->sin_port = htons(atoi(port));
+                sin->sin_addr.s_addr = htonl(INADDR_ANY);
+                addrlen = sizeof(struct sockaddr_in);
+            }
+        }
+
+        // else resolve host
+        else if (valid)
+        {
+            struct addrinfo hints;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+            struct addrinfo* info;
+            if (getaddrinfo(host, port, &hints, &info) == 0)
+            {
+                memcpy(&addr, info->ai_addr, info->ai_addrlen);
+                addrlen = info->ai_addrlen;
+                freeaddrinfo(info);
+            }
+        }
+    }
+    if (addrlen == 0)
+    {
+        printf("\033[33m");
+        printf("Can't listen on %s", address);
+        printf("\033[39m\n");
+        errno = EINVAL;
+        return -1;
+    }
+
+    // create a socket (not to be inherited by programs executed, e.g., a successor,
+    // to which sockets are instead handed down)
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    if (addr.ss_family != AF_UNIX)
+    {
+        // allow reuse of address (to avoid "Address already in use")
+        int optval = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+
+        // allow other sockets (i.e., workers') to bind to the same port
+        if (shared && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) == -1)
+        {
+            close(fd);
+            return -1;
+        }
+
+        // accept IPv4 clients too, if listening on all of IPv6's addresses
+        int v6only = 0;
+        if (addr.ss_family == AF_INET6)
+        {
+            setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+        }
+    }
+
+    // assign name to socket
+    if (bind(fd, (struct sockaddr*) &addr, addrlen) == -1)
+    {
+        printf("\033[33m");
+        printf("%s already in use", address);
+        printf("\033[39m\n");
+        close(fd);
+        return -1;
+    }
+
+    // listen for connections
+    if (listen(fd, SOMAXCONN) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+#ifdef __linux__
+    // wake server only once a client's request has arrived (if it does within DeferAccept),
+    // and let clients send requests within their SYNs (per TCP Fast Open), saving a round
+    // trip, if kernel allows (via net.ipv4.tcp_fastopen), since a request that's replayed
+    // (as one in a SYN could be) is only ever a GET
+    // https://tools.ietf.org/html/rfc7413#section-6.3.1
+    if (addr.ss_family != AF_UNIX)
+    {
+        int seconds = DeferAccept;
+        setsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &seconds, sizeof(seconds));
+        int queue = FastOpen;
+        setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &queue, sizeof(queue));
+    }
+#endif
+
+    // accept connections without blocking
+    if (fcntl(fd, F_SETFL, O_NONBLOCK) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // announce address in use (with port, if any, as assigned, if 0 was asked for)
+    addrlen = sizeof(addr);
+    if (getsockname(fd, (struct sockaddr*) &addr, &addrlen) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+    if (announce)
+    {
+        char name[INET6_ADDRSTRLEN];
+        printf("\033[33m");
+        if (addr.ss_family == AF_INET6)
+        {
+            const struct sockaddr_in6* sin6 = (const struct sockaddr_in6*) &addr;
+            printf("Listening on [%s]:%i", inet_ntop(AF_INET6, &sin6->sin6_addr, name, sizeof(name)),
+                ntohs(sin6->sin6_port));
+        }
+        else if (addr.ss_family == AF_INET)
+        {
+            const struct sockaddr_in* sin = (const struct sockaddr_in*) &addr;
+            printf("Listening on %s:%i", inet_ntop(AF_INET, &sin->sin_addr, name, sizeof(name)), ntohs(sin->sin_port));
+        }
+        else
+        {
+            printf("Listening on %s", address);
+        }
+        printf("\033[39m\n");
+    }
+    return fd;
+}
+
+/**
+ * Decodes HPACK string literal at *p (before end), Huffman-encoded or not, into t,
+ * which has room for size bytes, advancing *p past it. Returns its length, else -1
+ * if invalid (or too long).
+ * https://tools.ietf.org/html/rfc7541#section-5.2
+ */
+long literal(const unsigned char** p, const unsigned char* end, char* t, size_t size)
+{
+    if (*p == end)
+    {
+        return -1;
+    }
+    bool coded = (**p & 0x80) != 0;
+    size_t n;
+    if (!integer(p, end, 7, &n) || n > (size_t) (end - *p))
+    {
+        return -1;
+    }
+    long m = -1;
+    if (coded)
+    {
+        m = huffman(*p, n, t, size);
+    }
+    else if (n <= size)
+    {
+        memcpy(t, *p, n);
+        m = n;
+    }
+    *p += n;
+    return m;
+}
+
+/**
+ * Reads length bytes from file into dynamically allocated memory, which must be
+ * deallocated by caller. Returns NULL if file proves shorter than that (or on error).
+ */
+BYTE* load(int file, size_t length)
+{
+    BYTE* body = malloc(length + 1);
+    for (size_t loaded = 0; body != NULL && loaded < length; )
+    {
+        ssize_t bytes = read(file, body + loaded, length - loaded);
+        if (bytes == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            free(body);
+            return NULL;
+        }
+        loaded += bytes;
+    }
+    return body;
+}
+
+/**
+ * Looks up path in snapshot. Returns route, else NULL.
+ */
+struct route* locate(const char* path)
+{
+    if (nsnapshot == 0)
+    {
+        return NULL;
+    }
+    unsigned long h = hash(path);
+    struct route* r = snapshot[h & (nsnapshot - 1)];
+    while (r != NULL && (r->hash != h || strcmp(r->path, path) != 0))
+    {
+        r = r->chain;
+    }
+    return r;
+}
+
+/**
+ * Returns MIME type for file at path, per its extension (case-insensitively),
+ * else NULL if path has no extension or one that's not supported.
+ */
+const char* lookup(const char* path)
+{
+    // find extension in path's last segment
+    const char* dot = strrchr(path, '.');
+    if (dot == NULL || strchr(dot, '/') != NULL)
+    {
+        return NULL;
+    }
+
+    // lowercase extension, ignoring any too long to be supported
+    size_t n = strlen(dot + 1);
+    if (n == 0 || n > MIME_EXTENSION_MAX)
+    {
+        return NULL;
+    }
+    char extension[MIME_EXTENSION_MAX + 1];
+    for (size_t i = 0; i <= n; i++)
+    {
+        extension[i] = tolower((unsigned char) dot[1 + i]);
+    }
+    unsigned int h = mimehash(extension, 0);
+
+    // prefer types loaded at startup
+    if (loaded > 0)
+    {
+        for (size_t i = h & (slots - 1); extensions[i] != NULL; i = (i + 1) & (slots - 1))
+        {
+            if (strcmp(extensions[i], extension) == 0)
+            {
+                return types[i];
+            }
+        }
+    }
+
+    // look up built-in type, whose slot (if any) is determined by its bucket's displacement
+    unsigned int slot = mimehash(extension, displacements[h % MIME_EXTENSIONS]) % MIME_EXTENSIONS;
+    return (strcmp(mimes[slot].extension, extension) == 0) ? mimes[slot].type : NULL;
+}
+
+/**
+ * Records in this process's metrics a latency of stage, in whichever bucket of its
+ * histogram holds nanoseconds, each power of two's range being split into SUBBUCKETS,
+ * and adds it to connection's span of stage (unless connection is NULL), firing
+ * a probe thereof.
+ */
+void measure(struct connection* c, enum stage stage, long long nanoseconds)
+{
+    if (c != NULL)
+    {
+        c->spans[stage] += nanoseconds;
+    }
+    DTRACE_PROBE3(server, stage, stages[stage], nanoseconds, (c != NULL) ? c->fd : -1);
+
+    unsigned long long v = (nanoseconds > 0) ? nanoseconds : 0;
+    int i = v;
+    if (v >= SUBBUCKETS)
+    {
+        int shift = (63 - __builtin_clzll(v)) - __builtin_ctz(SUBBUCKETS);
+        i = (shift + 1) * SUBBUCKETS + (int) ((v >> shift) - SUBBUCKETS);
+    }
+    tally(&meter->latencies[stage][(i < BUCKETS) ? i : BUCKETS - 1], 1);
+    tally(&meter->sums[stage], v);
+}
+
+/**
+ * Advances HTTP/2 connection as far as it can go without blocking: handles as many
+ * frames as client has sent, then lets its streams (the most urgent first, the equally
+ * urgent in turn) frame as much of their responses as windows allow, then writes as
+ * many frames as its socket will accept.
+ * https://tools.ietf.org/html/rfc7540
+ */
+void multiplex(struct connection* c)
+{
+    struct session* s = c->session;
+    s->handling = true;
+    while (c->state != CLOSING)
+    {
+        // handle whatever frames have been read in their entirety
+        size_t offset = 0;
+        while (c->state != CLOSING)
+        {
+            // expect (rest of) client's connection preface first
+            // https://tools.ietf.org/html/rfc7540#section-3.5
+            if (*s->preface != '\0')
+            {
+                size_t n = strlen(s->preface);
+                n = (s->length - offset < n) ? s->length - offset : n;
+                if (memcmp(s->input + offset, s->preface, n) != 0)
+                {
+                    c->state = CLOSING;
+                    break;
+                }
+                s->preface += n;
+                offset += n;
+                if (*s->preface != '\0')
+                {
+                    break;
+                }
+            }
+            if (s->length - offset < 9)
+            {
+                break;
+            }
+            const unsigned char* h = (const unsigned char*) s->input + offset;
+            size_t length = (h[0] << 16) | (h[1] << 8) | h[2];
+            if (length > FRAME)
+            {
+                abandon(c, HTTP2_FRAME_SIZE_ERROR);
+                c->state = CLOSING;
+                break;
+            }
+            if (s->length - offset < 9 + length)
+            {
+                break;
+            }
+            unsigned int id = ((h[5] & 0x7f) << 24) | (h[6] << 16) | (h[7] << 8) | h[8];
+            if (!receive(c, h[3], h[4], id, s->input + offset + 9, length))
+            {
+                c->state = CLOSING;
+                break;
+            }
+            offset += 9 + length;
+        }
+        s->length -= offset;
+        memmove(s->input, s->input + offset, s->length);
+        if (c->state == CLOSING)
+        {
+            break;
+        }
+
+        // read more frames
+        ssize_t bytes = pull(c, s->input + s->length, sizeof(s->input) - s->length);
+        if (bytes == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if (bytes <= 0)
+        {
+            c->state = CLOSING;
+            break;
+        }
+        s->length += bytes;
+    }
+
+    // let streams frame their responses (or, if upgraded, dispatch an upgrading
+    // request, once preface has arrived), the most urgent first, the equally urgent
+    // in turn, with whichever went first going last next time
+    // https://tools.ietf.org/html/rfc9218#section-10
+    for (int urgency = 0; urgency < 8 && c->state != CLOSING; urgency++)
+    {
+        struct connection* next;
+        for (struct connection* t = s->streams; t != NULL; t = next)
+        {
+            next = t->sibling;
+            if (t->urgency == urgency && (t->state == WRITING || t->state == WAITING
+                || (t->state == READING && *s->preface == '\0')))
+            {
+                advance(t);
+            }
+        }
+    }
+    if (s->nstreams > 1)
+    {
+        struct connection* first = s->streams;
+        struct connection** p = &s->streams;
+        s->streams = first->sibling;
+        while (*p != NULL)
+        {
+            p = &(*p)->sibling;
+        }
+        *p = first;
+        first->sibling = NULL;
+    }
+
+    // write queued frames, then close connection if client (or server) has gone away
+    // and streams are done, else allow client only so long to accept frames, or (if
+    // no streams are open) to open another
+    bool flushed = transmit(c);
+    s->handling = false;
+    if (s->going && s->nstreams == 0 && flushed)
+    {
+        c->state = CLOSING;
+    }
+    if (c->state == CLOSING)
+    {
+        if (c->fd != -1)
+        {
+            hangup(c);
+        }
+        return;
+    }
+    timeout(c, !flushed ? Timeout : (s->nstreams == 0) ? KeepAliveTimeout : 0);
+}
+
+/**
+ * Returns number of nanoseconds since some unspecified (but fixed) point in time.
+ */
+long long nanotime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Determines which content-codings (other than identity) an Accept-Encoding header,
+ * whose value is n bytes long, deems acceptable, ignoring codings whose weight is 0.
+ * Returns a bitmask thereof.
+ * https://tools.ietf.org/html/rfc7231#section-5.3.4
+ */
+unsigned int negotiate(const char* value, size_t n)
+{
+    unsigned int accepted = 0, mentioned = 0;
+    bool wildcard = false;
+    for (size_t i = 0; i < n; )
+    {
+        // skip separators
+        if (value[i] == ',' || value[i] == ' ' || value[i] == '\t')
+        {
+            i++;
+            continue;
+        }
+
+        // find coding's name
+        size_t start = i;
+        while (i < n && value[i] != ',' && value[i] != ';' && value[i] != ' ' && value[i] != '\t')
+        {
+            i++;
+        }
+        size_t length = i - start;
+
+        // find coding's weight, if any, which is 0 iff it has no nonzero digit
+        bool acceptable = true;
+        while (i < n && value[i] != ',')
+        {
+            if (value[i] == ';')
+            {
+                do
+                {
+                    i++;
+                }
+                while (i < n && (value[i] == ' ' || value[i] == '\t'));
+                if (i + 1 < n && (value[i] == 'q' || value[i] == 'Q') && value[i + 1] == '=')
+                {
+                    acceptable = false;
+                    for (i += 2; i < n && value[i] != ',' && value[i] != ';'; i++)
+                    {
+                        acceptable = acceptable || (value[i] >= '1' && value[i] <= '9');
+                    }
+                }
+                continue;
+            }
+            i++;
+        }
+
+        // remember coding
+        if (length == 1 && value[start] == '*')
+        {
+            wildcard = acceptable;
+            continue;
+        }
+        for (int j = IDENTITY + 1; j < CODINGS; j++)
+        {
+            if ((length == strlen(codings[j]) && strncasecmp(value + start, codings[j], length) == 0)
+                || (j == GZIP && length == strlen("x-gzip") && strncasecmp(value + start, "x-gzip", length) == 0))
+            {
+                mentioned |= 1 << j;
+                if (acceptable)
+                {
+                    accepted |= 1 << j;
+                }
+            }
+        }
+    }
+
+    // * stands for any coding not otherwise mentioned
+    if (wildcard)
+    {
+        accepted |= ~mentioned & (((1 << CODINGS) - 1) & ~(1 << IDENTITY));
+    }
+    return accepted;
+}
+
+/**
+ * Queues a frame of specified type for stream id whose payload is value alone, in 32
+ * bits (e.g., RST_STREAM's error code or WINDOW_UPDATE's increment). Returns true iff
+ * successful.
+ */
+bool notify(struct connection* c, int type, unsigned int id, unsigned int value)
+{
+    BYTE payload[4] = {value >> 24, value >> 16, value >> 8, value};
+    return post(c, type, 0, id, payload, sizeof(payload));
+}
+
+/**
+ * Returns number of milliseconds since some unspecified (but fixed) point in time.
+ */
+long now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Watches (with inotify) directory containing path, along with its ancestors
+ * up to and including server's root. Returns true iff all are being watched.
+ */
+bool observe(const char* path)
+{
+#ifdef __linux__
+    if (ifd == -1)
+    {
+        return false;
+    }
+
+    // iterate over ancestors, from directory containing path up to root
+    char directory[strlen(path) + 1];
+    strcpy(directory, path);
+    size_t n = strlen(root);
+    char* slash;
+    while ((slash = strrchr(directory, '/')) != NULL && slash - directory >= n)
+    {
+        *slash = '\0';
+
+        // skip directory if already watched
+        size_t i = 0;
+        while (i < watches && strcmp(directories[i], directory) != 0)
+        {
+            i++;
+        }
+        if (i < watches)
+        {
+            continue;
+        }
+
+        // watch directory
+        int wd = inotify_add_watch(ifd, directory, IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE
+            | IN_DELETE | IN_DELETE_SELF | IN_MODIFY | IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO);
+        if (wd == -1)
+        {
+            return false;
+        }
+
+        // remember watch
+        int* w = realloc(wds, (watches + 1) * sizeof(int));
+        if (w == NULL)
+        {
+            inotify_rm_watch(ifd, wd);
+            return false;
+        }
+        wds = w;
+        char** d = realloc(directories, (watches + 1) * sizeof(char*));
+        if (d == NULL)
+        {
+            inotify_rm_watch(ifd, wd);
+            return false;
+        }
+        directories = d;
+        directories[watches] = strdup(directory);
+        if (directories[watches] == NULL)
+        {
+            inotify_rm_watch(ifd, wd);
+            return false;
+        }
+        wds[watches] = wd;
+        watches++;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Translates n bytes of an HTTP/1.1 response's headers (from Status-Line through their
+ * final CRLF) into an HPACK header block at block, which must have room for twice as
+ * many bytes (plus a few). Fields are encoded as literals, never indexed, with names
+ * indexed in static table where possible, and none Huffman-encoded, so that encoding
+ * is hardly more than copying. Fields that HTTP/2 forbids (e.g., Connection) are dropped.
+ * Returns block's length.
+ * https://tools.ietf.org/html/rfc7541#section-6.2.2
+ */
+size_t pack(const BYTE* headers, size_t n, BYTE* block)
+{
+    // status code, indexed if in static table
+    const char* code = headers + strlen("HTTP/1.1 ");
+    BYTE* b = block;
+    int index = 0;
+    for (int i = 8; i <= 14 && index == 0; i++)
+    {
+        index = (strncmp(statics[i][1], code, 3) == 0) ? i : 0;
+    }
+    if (index != 0)
+    {
+        b += emit(b, 0x80, 7, index);
+    }
+    else
+    {
+        b += emit(b, 0x00, 4, 8);
+        b += emit(b, 0x00, 7, 3);
+        memcpy(b, code, 3);
+        b += 3;
+    }
+
+    // fields, each on a line of its own
+    const char* end = headers + n - 2;
+    for (const char* line = find(headers, n, '\n') + 1; line < end; )
+    {
+        const char* lf = find(line, end + 2 - line, '\n');
+        const char* colon = find(line, lf - line, ':');
+        if (colon != NULL && !specific(line, colon - line))
+        {
+            // name, indexed if in static table, else lowercased
+            size_t m = colon - line;
+            index = 0;
+            for (int i = 15; i < (int) (sizeof(statics) / sizeof(statics[0])) && index == 0; i++)
+            {
+                if (statics[i][0][0] == tolower((unsigned char) line[0]) && strlen(statics[i][0]) == m
+                    && strncasecmp(statics[i][0], line, m) == 0)
+                {
+                    index = i;
+                }
+            }
+            if (index != 0)
+            {
+                b += emit(b, 0x00, 4, index);
+            }
+            else
+            {
+                b += emit(b, 0x00, 4, 0);
+                b += emit(b, 0x00, 7, m);
+                for (size_t i = 0; i < m; i++)
+                {
+                    *b++ = tolower((unsigned char) line[i]);
+                }
+            }
+
+            // value, sans whitespace before it and CRLF after it
+            const char* value = colon + 1;
+            while (*value == ' ')
+            {
+                value++;
+            }
+            size_t k = (lf - 1 > value) ? lf - 1 - value : 0;
+            b += emit(b, 0x00, 7, k);
+            memcpy(b, value, k);
+            b += k;
+        }
+        line = lf + 1;
+    }
+    return b - block;
+}
+
+/**
+ * Encodes a FastCGI name-value pair, with name of length m and value of length n,
+ * at p, unless p is NULL. Returns number of bytes in encoding.
+ */
+size_t pair(BYTE* p, const char* name, size_t m, const char* value, size_t n)
+{
+    // encode lengths, each in 1 byte if less than 128, else 4
+    size_t length = 0;
+    size_t lengths[] = {m, n};
+    for (int i = 0; i < 2; i++)
+    {
+        if (lengths[i] < 128)
+        {
+            if (p != NULL)
+            {
+                p[length] = lengths[i];
+            }
+            length += 1;
+        }
+        else
+        {
+            if (p != NULL)
+            {
+                p[length] = ((lengths[i] >> 24) & 0x7f) | 0x80;
+                p[length + 1] = (lengths[i] >> 16) & 0xff;
+                p[length + 2] = (lengths[i] >> 8) & 0xff;
+                p[length + 3] = lengths[i] & 0xff;
+            }
+            length += 4;
+        }
+    }
+
+    // encode name and value
+    if (p != NULL)
+    {
+        memcpy(p + length, name, m);
+        memcpy(p + length + m, value, n);
+    }
+    return length + m + n;
+}
+
+/**
+ * Prepares to perform jobs asynchronously, via io_uring (with which an eventfd is
+ * registered, to be watched by event loop) if available, else via a pool of threads.
+ * Returns true iff jobs are to be performed asynchronously.
+ */
+bool offload(void)
+{
+#ifdef __linux__
+    nfd[0] = nfd[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+    if (pipe(nfd) == -1 || fcntl(nfd[0], F_SETFL, O_NONBLOCK) == -1)
+    {
+        nfd[0] = nfd[1] = -1;
+    }
+#endif
+    if (nfd[0] == -1)
+    {
+        return false;
+    }
+    if (!watch(nfd[0], nfd))
+    {
+        close(nfd[0]);
+        nfd[0] = nfd[1] = -1;
+        return false;
+    }
+
+#ifdef __linux__
+    // set up io_uring, ensuring that it supports each of jobs' operations
+    // https://kernel.dk/io_uring.pdf
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    ufd = syscall(__NR_io_uring_setup, ENTRIES, &p);
+    if (ufd != -1)
+    {
+        struct
+        {
+            struct io_uring_probe probe;
+            struct io_uring_probe_op ops[IORING_OP_LAST];
+        }
+        probe;
+        memset(&probe, 0, sizeof(probe));
+        bool supported = syscall(__NR_io_uring_register, ufd, IORING_REGISTER_PROBE, &probe, IORING_OP_LAST) == 0;
+        int ops[] = {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ};
+        for (int i = 0; i < sizeof(ops) / sizeof(ops[0]) && supported; i++)
+        {
+            supported = (ops[i] <= probe.probe.last_op && (probe.ops[ops[i]].flags & IO_URING_OP_SUPPORTED));
+        }
+
+        // map rings (which might share a mapping) and submission queue's entries
+        size_t sqsize = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+        size_t cqsize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            sqsize = cqsize = (sqsize > cqsize) ? sqsize : cqsize;
+        }
+        BYTE* sq = MAP_FAILED;
+        BYTE* cq = MAP_FAILED;
+        if (supported)
+        {
+            sq = mmap(NULL, sqsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ufd, IORING_OFF_SQ_RING);
+            cq = (p.features & IORING_FEAT_SINGLE_MMAP) ? sq
+                : mmap(NULL, cqsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ufd, IORING_OFF_CQ_RING);
+            sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, ufd, IORING_OFF_SQES);
+        }
+        if (sq != MAP_FAILED && cq != MAP_FAILED && sqes != MAP_FAILED
+            && syscall(__NR_io_uring_register, ufd, IORING_REGISTER_EVENTFD, &nfd[0], 1) == 0)
+        {
+            sqhead = (unsigned int*) (sq + p.sq_off.head);
+            sqtail = (unsigned int*) (sq + p.sq_off.tail);
+            sqmask = (unsigned int*) (sq + p.sq_off.ring_mask);
+            sqarray = (unsigned int*) (sq + p.sq_off.array);
+            cqhead = (unsigned int*) (cq + p.cq_off.head);
+            cqtail = (unsigned int*) (cq + p.cq_off.tail);
+            cqmask = (unsigned int*) (cq + p.cq_off.ring_mask);
+            cqes = (struct io_uring_cqe*) (cq + p.cq_off.cqes);
+            return true;
+        }
+
+        // else fall back to threads (leaving rings' mappings, if any, to be
+        // removed by exit)
+        close(ufd);
+        ufd = -1;
+        sqes = NULL;
+    }
+#endif
+
+    // spawn threads, detached, since they run until process exits
+    for (int i = 0; i < THREADS; i++)
+    {
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (pthread_create(&thread, &attr, work, NULL) == 0)
+        {
+            threads = true;
+        }
+        pthread_attr_destroy(&attr);
+    }
+    return threads;
+}
+
+/**
+ * Parses a request-line, storing its absolute-path at abs_path 
+ * and its query string at query, both of which are assumed
+ * to be at least of length LimitRequestLine + 1.
+ */
+bool parse(const struct connection* c, char* abs_path, char* query)
+{
+	// Request-line, as parsed already, in place
+	const char* line = c->message + c->parsed.request.start;
+	size_t length = c->parsed.request.length;
+
+	// Look for first space in request line
+	const char* firstSpace = find(line, length, ' ');
+	
+	// Bad Request has no space
+	if(firstSpace == NULL)
+	{
+		error(400);
+		return false;
+	}
+
+	// Method not allowed other than GET
+	if (firstSpace - line != 3 || strncmp(line, "GET", 3) != 0)
+	{
+		error(405);
+		return false;
+	}
+
+	// Look for second (i.e., last) space in line
+	const char* secondSpace = line + length - 1;
+	while (*secondSpace != ' ')
+	{
+		secondSpace--;
+	}
+
+	// Bad Request has no request-target
+	if (secondSpace == firstSpace)
+	{
+		error(400);
+		return false;
 	}
 
-	// Look for second space in line
-	char* secondSpace = strrchr(line, ' ');
-	
-	// Extract request-target
-	int requestSize = (int)(secondSpace - firstSpace - 1);
-	char request[requestSize + 1];
-	strncpy(request, firstSpace+1, requestSize);
-    request[requestSize] = '\0';
+	// Extract request-target
+	const char* request = firstSpace + 1;
+	size_t requestSize = secondSpace - request;
+
+	// Must begin with /
+	if (request[0] != '/')
+	{
+		error(501);
+		return false;
+	}
+
+	// Must not have "
+	if (find(request, requestSize, '"') != NULL)
+	{
+		error(400);
+		return false;
+	}
+
+	// Only HTTP/1.1 supported (plus HTTP/2, as translated, for streams)
+	const char* version = secondSpace + 1;
+	if (line + length - version != 8 || (strncmp(version, "HTTP/1.1", 8) != 0
+		&& (c->parent == NULL || strncmp(version, "HTTP/2.0", 8) != 0)))
+	{
+		error(505);
+		return false;
+	}
+
+	//Extract abs_path and query
+	const char* queryBegins = find(request, requestSize, '?');
+	if (queryBegins != NULL)
+	{
+		memcpy(abs_path, request, queryBegins - request);
+		abs_path[queryBegins - request] = '\0';
+
+		memcpy(query, queryBegins + 1, secondSpace - queryBegins - 1);
+		query[secondSpace - queryBegins - 1] = '\0';
+	}
+	else
+	{
+		memcpy(abs_path, request, requestSize);
+		abs_path[requestSize] = '\0';
+		query[0] = '\0';
+	}
+
+	return true;
+}
+
+/**
+ * Parses client's Range header into ranges of a representation that's length bytes
+ * long, whose entity-tag is etag and which was last modified at mtime, unless If-Range
+ * deems ranges stale. Returns number of satisfiable ranges, storing them in *ranges
+ * (as memory allotted from client's arena, which lasts as long as request), else 0 if
+ * Range is absent (or to be ignored), else -1 if no range is satisfiable.
+ * https://tools.ietf.org/html/rfc7233#section-3.1
+ */
+int partition(off_t length, const char* etag, time_t mtime, struct range** ranges)
+{
+    // ensure client asks for ranges of bytes
+    size_t n;
+    const char* value = header(client, "Range", &n);
+    if (value == NULL || n < strlen("bytes=") || strncasecmp(value, "bytes=", strlen("bytes=")) != 0)
+    {
+        return 0;
+    }
+
+    // ignore Range unless If-Range's entity-tag (compared strongly) or date matches
+    // https://tools.ietf.org/html/rfc7233#section-3.2
+    size_t m;
+    const char* condition = header(client, "If-Range", &m);
+    if (condition != NULL && condition[0] == '"')
+    {
+        if (m != strlen(etag) || strncmp(condition, etag, m) != 0)
+        {
+            return 0;
+        }
+    }
+    else if (condition != NULL && when(condition, m) != mtime)
+    {
+        return 0;
+    }
+
+    // parse byte-range-set, ignoring Range altogether if it's invalid
+    struct range* r = allot(client, MaxRanges * sizeof(struct range));
+    if (r == NULL)
+    {
+        return 0;
+    }
+    int parts = 0, specs = 0;
+    bool satisfiable = false;
+    off_t sum = 0;
+    for (size_t i = strlen("bytes="); i < n; )
+    {
+        // skip separators
+        if (value[i] == ',' || value[i] == ' ' || value[i] == '\t')
+        {
+            i++;
+            continue;
+        }
+
+        // parse first-byte-pos (if any), -, and last-byte-pos (or suffix-length, if any)
+        long long first = -1, last = -1;
+        for (; i < n && isdigit((unsigned char) value[i]) && first < LLONG_MAX / 10 - 10; i++)
+        {
+            first = ((first == -1) ? 0 : first * 10) + (value[i] - '0');
+        }
+        if (i == n || value[i] != '-')
+        {
+            return 0;
+        }
+        for (i++; i < n && isdigit((unsigned char) value[i]) && last < LLONG_MAX / 10 - 10; i++)
+        {
+            last = ((last == -1) ? 0 : last * 10) + (value[i] - '0');
+        }
+        if ((i < n && value[i] != ',' && value[i] != ' ' && value[i] != '\t')
+            || (first == -1 && last == -1) || (first != -1 && last != -1 && last < first))
+        {
+            return 0;
+        }
+        specs++;
+
+        // resolve suffix-length against representation's length
+        if (first == -1)
+        {
+            if (last == 0)
+            {
+                continue;
+            }
+            first = (last < length) ? length - last : 0;
+            last = length - 1;
+        }
+
+        // ignore ranges that start beyond representation
+        if (first >= length)
+        {
+            continue;
+        }
+        if (last == -1 || last >= length)
+        {
+            last = length - 1;
+        }
+        satisfiable = true;
+
+        // ignore too many ranges, or ranges (e.g., overlapping ones) that sum
+        // to more than representation itself
+        sum += last - first + 1;
+        if (parts == MaxRanges || sum > length)
+        {
+            return 0;
+        }
+        r[parts].first = first;
+        r[parts].last = last;
+        parts++;
+    }
+    if (!satisfiable)
+    {
+        return (specs > 0) ? -1 : 0;
+    }
+    *ranges = r;
+    return parts;
+}
+
+/**
+ * Performs job's remaining phases, blocking as needed.
+ */
+void perform(struct job* j)
+{
+    // open file
+    if (j->phase == OPENING)
+    {
+        j->file = open(j->path, O_RDONLY | O_CLOEXEC);
+        j->error = (j->file == -1) ? errno : 0;
+        j->phase = (j->file == -1) ? DONE : STATING;
+    }
+
+    // determine file's metadata
+    if (j->phase == STATING)
+    {
+        j->error = (fstat(j->file, &j->sb) == -1) ? errno : 0;
+        j->phase = (j->error == 0 && j->sb.st_size <= CacheMaxFileSize) ? LOADING : DONE;
+    }
+
+    // load file's content, if small enough to cache
+    if (j->phase == LOADING)
+    {
+        BYTE* body = (j->body == NULL) ? load(j->file, j->sb.st_size) : NULL;
+        if (j->body != NULL)
+        {
+            // finish loading what io_uring started
+            while (j->length < j->sb.st_size)
+            {
+                ssize_t bytes = pread(j->file, j->body + j->length, j->sb.st_size - j->length, j->length);
+                if (bytes == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (bytes <= 0)
+                {
+                    free(j->body);
+                    j->body = NULL;
+                    break;
+                }
+                j->length += bytes;
+            }
+        }
+        else if (body != NULL)
+        {
+            j->body = body;
+            j->length = j->sb.st_size;
+        }
+        j->phase = DONE;
+    }
+}
+
+/**
+ * Queues a frame of specified type, with flags, for stream id (or 0, for connection
+ * itself) with length bytes of payload. Returns true iff successful.
+ * https://tools.ietf.org/html/rfc7540#section-4.1
+ */
+bool post(struct connection* c, int type, int flags, unsigned int id, const BYTE* payload, size_t length)
+{
+    if (!grow(c, 9 + length))
+    {
+        return false;
+    }
+    BYTE* p = c->response + c->size;
+    p[0] = length >> 16;
+    p[1] = length >> 8;
+    p[2] = length;
+    p[3] = type;
+    p[4] = flags;
+    p[5] = (id >> 24) & 0x7f;
+    p[6] = id >> 16;
+    p[7] = id >> 8;
+    p[8] = id;
+    if (length > 0)
+    {
+        memcpy(p + 9, payload, length);
+    }
+    c->size += 9 + length;
+    return true;
+}
+
+/**
+ * Prepares this process's event loop, watching server's socket
+ * for connections. Returns true iff successful.
+ */
+bool prepare(void)
+{
+    // create event loop
+#ifdef __linux__
+    efd = epoll_create1(EPOLL_CLOEXEC);
+#else
+    efd = kqueue();
+#endif
+    if (efd == -1)
+    {
+        return false;
+    }
+
+#ifdef __linux__
+    // watch for changes to cached files, unless root's frozen (and so can't change)
+    ifd = frozen ? -1 : inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (ifd != -1 && !watch(ifd, &ifd))
+    {
+        close(ifd);
+        ifd = -1;
+    }
+#endif
+
+    // perform blocking file-system operations asynchronously, if possible
+    offload();
+
+    // write access log, if any, from a thread of its own, detached, since it runs
+    // until process exits
+    if (lfd != -1)
+    {
+        notes = malloc(NOTES * sizeof(struct note));
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        bool started = (notes != NULL && pthread_create(&thread, &attr, scribe, NULL) == 0);
+        pthread_attr_destroy(&attr);
+        if (!started)
+        {
+            return false;
+        }
+    }
+
+    // watch server's sockets for connections
+    for (int i = 0; i < nendpoints; i++)
+    {
+        if (!watch(endpoints[i].fd, &endpoints[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Adds path's route to snapshot, along with (unless it's a PHP file, which is to
+ * be interpreted, or unreadable) its file's content, headers, and encodings
+ * thereof. Returns true iff successful (i.e., unless out of memory).
+ */
+bool preserve(const char* path)
+{
+    // resolve path (anew, since routes aren't cached before event loop)
+    struct route* r = resolve(path);
+    if (r == NULL)
+    {
+        return false;
+    }
+
+    // share entry with file's own route, if already preserved
+    struct route* f = (r->target == REGULAR && r->type != NULL) ? locate(r->file) : NULL;
+    if (f != NULL)
+    {
+        r->entry = f->entry;
+    }
+
+    // else load file (and headers), encoding it in each content-coding
+    else if (r->target == REGULAR && r->type != NULL && strcasecmp("text/x-php", r->type) != 0)
+    {
+        struct stat sb;
+        int file = open(r->file, O_RDONLY | O_CLOEXEC);
+        if (file != -1 && fstat(file, &sb) == 0 && S_ISREG(sb.st_mode))
+        {
+            struct entry* e = calloc(1, sizeof(struct entry));
+            int n = label(NULL, 0, r->type, IDENTITY, &sb);
+            if (e == NULL || n < 0 || (e->path = strdup(r->file)) == NULL
+                || (e->headers[IDENTITY] = malloc(n + 1)) == NULL
+                || (e->body[IDENTITY] = load(file, sb.st_size)) == NULL)
+            {
+                if (e != NULL)
+                {
+                    release(e);
+                }
+                close(file);
+                forget(r);
+                return false;
+            }
+            label(e->headers[IDENTITY], n + 1, r->type, IDENTITY, &sb);
+            e->hash = hash(e->path);
+            e->sb = sb;
+            e->watched = true;
+            e->type = r->type;
+            e->length[IDENTITY] = sb.st_size;
+            e->tried[IDENTITY] = true;
+            e->references = 1;
+            e->cached = true;
+            e->packed = true;
+            for (int i = IDENTITY + 1; i < CODINGS; i++)
+            {
+                encode(e, i);
+            }
+            r->entry = e;
+        }
+        if (file != -1)
+        {
+            close(file);
+        }
+    }
+
+    // grow hash table as needed, so that chains stay short
+    if (snapshotted >= nsnapshot)
+    {
+        size_t m = (nsnapshot == 0) ? 1024 : nsnapshot * 2;
+        struct route** b = calloc(m, sizeof(struct route*));
+        if (b == NULL)
+        {
+            forget(r);
+            return false;
+        }
+        for (size_t i = 0; i < nsnapshot; i++)
+        {
+            while (snapshot[i] != NULL)
+            {
+                struct route* next = snapshot[i]->chain;
+                snapshot[i]->chain = b[snapshot[i]->hash & (m - 1)];
+                b[snapshot[i]->hash & (m - 1)] = snapshot[i];
+                snapshot[i] = next;
+            }
+        }
+        free(snapshot);
+        snapshot = b;
+        nsnapshot = m;
+    }
+
+    // insert route into hash table, whereafter it's never freed
+    r->chain = snapshot[r->hash & (nsnapshot - 1)];
+    snapshot[r->hash & (nsnapshot - 1)] = r;
+    r->cached = true;
+    snapshotted++;
+    return true;
+}
+
+/**
+ * Parses urgency from n bytes of value of Priority (or of PRIORITY_UPDATE), a
+ * dictionary per Structured Field Values, whose incremental parameter is moot, since
+ * equally urgent streams take turns regardless. Returns urgency or, if absent, given one.
+ * https://tools.ietf.org/html/rfc9218#section-4
+ */
+int prioritize(const char* value, size_t n, int urgency)
+{
+    for (size_t i = 0; i + 2 < n; i++)
+    {
+        if ((i == 0 || value[i - 1] == ' ' || value[i - 1] == ',') && value[i] == 'u' && value[i + 1] == '='
+            && value[i + 2] >= '0' && value[i + 2] <= '7'
+            && (i + 3 == n || value[i + 3] == ',' || value[i + 3] == ' ' || value[i + 3] == ';'))
+        {
+            return value[i + 2] - '0';
+        }
+    }
+    return urgency;
+}
+
+/**
+ * Reads (without blocking) up to n bytes from client into buffer, decrypting them
+ * (and completing TLS handshake first, if need be) if connection's over TLS.
+ * Returns number of bytes read, 0 if client hung up, else -1 (with errno set,
+ * e.g., to EAGAIN), just as read does.
+ */
+ssize_t pull(struct connection* c, void* buffer, size_t n)
+{
+    if (c->ssl == NULL)
+    {
+        return read(c->fd, buffer, n);
+    }
+    ERR_clear_error();
+    errno = 0;
+    int bytes = SSL_read(c->ssl, buffer, (n < INT_MAX) ? n : INT_MAX);
+    return (bytes > 0) ? bytes : translate(c, bytes);
+}
+
+/**
+ * Evicts from cache every entry whose path starts with prefix, else (if prefix is NULL)
+ * every entry.
+ */
+void purge(const char* prefix)
+{
+    size_t n = (prefix != NULL) ? strlen(prefix) : 0;
+    for (struct entry* e = hottest; e != NULL; )
+    {
+        struct entry* next = e->colder;
+        if (prefix == NULL || strncmp(e->path, prefix, n) == 0)
+        {
+            evict(e);
+        }
+        e = next;
+    }
+}
+
+/**
+ * Writes (without blocking) as much of iovcnt buffers to client as its socket will
+ * accept, encrypting them if connection's over TLS (in which case flags are ignored).
+ * Returns number of bytes written, else -1 (with errno set, e.g., to EAGAIN), just
+ * as sendmsg does.
+ */
+ssize_t push(struct connection* c, const struct iovec* iov, int iovcnt, int flags)
+{
+    if (c->ssl == NULL)
+    {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = (struct iovec*) iov;
+        msg.msg_iovlen = iovcnt;
+        return sendmsg(c->fd, &msg, flags);
+    }
+
+    // coalesce buffers into (up to) a record's worth, lest a response's headers
+    // be sent in a record of their own (a retry after EAGAIN coalesces same bytes
+    // anew, as OpenSSL permits with SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER)
+    BYTE record[BYTES * 32];
+    const void* data = iov[0].iov_base;
+    size_t n = iov[0].iov_len;
+    if (iovcnt > 1 && n < sizeof(record))
+    {
+        n = 0;
+        for (int i = 0; i < iovcnt && n < sizeof(record); i++)
+        {
+            size_t m = (iov[i].iov_len < sizeof(record) - n) ? iov[i].iov_len : sizeof(record) - n;
+            memcpy(record + n, iov[i].iov_base, m);
+            n += m;
+        }
+        data = record;
+    }
+    ERR_clear_error();
+    errno = 0;
+    int bytes = SSL_write(c->ssl, data, (n < INT_MAX) ? n : INT_MAX);
+    return (bytes > 0) ? bytes : translate(c, bytes);
+}
+
+/**
+ * Quiesces this process, which is to stop once its connections are done: stops
+ * listening on server's sockets (leaving them open in any other process, e.g.,
+ * a successor) and has HTTP/2 clients go away once their streams are done, while
+ * HTTP/1 connections close after their next responses (or, if idle, time out),
+ * lest a request already on its way be dropped. Stops once none are open.
+ */
+void quiesce(void)
+{
+    // stop listening
+    for (int i = 0; i < nendpoints; i++)
+    {
+        if (endpoints[i].fd != -1)
+        {
+#ifdef __linux__
+            epoll_ctl(efd, EPOLL_CTL_DEL, endpoints[i].fd, NULL);
+#endif
+            close(endpoints[i].fd);
+            endpoints[i].fd = -1;
+        }
+    }
+
+    // have HTTP/2 clients go away, rescanning slot after each, as expire does
+    for (int i = 0; i < SLOTS; i++)
+    {
+        struct connection* c = wheel[i];
+        while (c != NULL)
+        {
+            if (c->session != NULL && !c->session->going)
+            {
+                abandon(c, HTTP2_NO_ERROR);
+                advance(c);
+                c = wheel[i];
+            }
+            else
+            {
+                c = c->later;
+            }
+        }
+    }
+    if (connections == 0)
+    {
+        errno = 0;
+        stop();
+    }
+}
+
+/**
+ * Waits up to timeout milliseconds (or indefinitely, if timeout is negative) for
+ * watched sockets to become ready, storing the data with which each was watched
+ * in data, up to max. Returns number of sockets that are ready, else -1.
+ */
+int ready(void** data, int max, int timeout)
+{
+#ifdef __linux__
+    struct epoll_event events[max];
+    int n = epoll_wait(efd, events, max, timeout);
+    for (int i = 0; i < n; i++)
+    {
+        data[i] = events[i].data.ptr;
+    }
+#else
+    struct kevent events[max];
+    struct timespec ts = {timeout / 1000, (timeout % 1000) * 1000000};
+    int n = kevent(efd, NULL, 0, events, max, (timeout < 0) ? NULL : &ts);
+    for (int i = 0; i < n; i++)
+    {
+        data[i] = events[i].udata;
+    }
+#endif
+    return n;
+}
+
+/**
+ * Returns status code's reason phrase.
+ *
+ * http://www.w3.org/Protocols/rfc2616/rfc2616-sec6.html#sec6
+ * https://tools.ietf.org/html/rfc2324
+ */
+const char* reason(unsigned short code)
+{
+    switch (code)
+    {
+        case 200: return "OK";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 414: return "Request-URI Too Long";
+        case 416: return "Requested Range Not Satisfiable";
+        case 418: return "I'm a teapot";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default: return NULL;
+    }
+}
+
+/**
+ * Recalls field at index in HTTP/2 connection's table (static, then dynamic), copying
+ * its name and value, back to back, into field (which must have room for TABLE bytes)
+ * and storing their lengths in *names and *values. Returns true iff index is valid.
+ * https://tools.ietf.org/html/rfc7541#section-2.3.3
+ */
+bool recall(const struct session* s, size_t index, char* field, size_t* names, size_t* values)
+{
+    size_t n = sizeof(statics) / sizeof(statics[0]);
+    if (index == 0)
+    {
+        return false;
+    }
+    if (index < n)
+    {
+        *names = strlen(statics[index][0]);
+        *values = strlen(statics[index][1]);
+        memcpy(field, statics[index][0], *names);
+        memcpy(field + *names, statics[index][1], *values);
+        return true;
+    }
+
+    // newest field of dynamic table comes first
+    if (index - n >= s->nfields)
+    {
+        return false;
+    }
+    const struct field* f = &s->fields[(s->oldest + s->nfields - 1 - (index - n)) % (TABLE / 32)];
+    size_t m = f->name + f->value, first = (m < TABLE - f->offset) ? m : TABLE - f->offset;
+    memcpy(field, s->bytes + f->offset, first);
+    memcpy(field + first, s->bytes, m - first);
+    *names = f->name;
+    *values = f->value;
+    return true;
+}
+
+/**
+ * Handles a frame of specified type, with flags, for stream id (or 0, for connection
+ * itself) with length bytes of payload. Returns false iff connection is to be
+ * abandoned (with GOAWAY queued already).
+ * https://tools.ietf.org/html/rfc7540#section-6
+ */
+bool receive(struct connection* c, int type, int flags, unsigned int id, const BYTE* payload, size_t length)
+{
+    struct session* s = c->session;
+    const unsigned char* p = (const unsigned char*) payload;
+
+    // a header block, once begun, must continue uninterrupted
+    if (s->continuing != 0 && (type != HTTP2_CONTINUATION || id != s->continuing))
+    {
+        return abandon(c, HTTP2_PROTOCOL_ERROR);
+    }
+
+    // stream to which frame pertains, if open
+    struct connection* t = (id != 0) ? s->streams : NULL;
+    while (t != NULL && t->id != id)
+    {
+        t = t->sibling;
+    }
+    switch (type)
+    {
+        // discard request's body (as over HTTP/1.1), crediting windows right away
+        case HTTP2_DATA:
+            if (id == 0 || id > s->highest)
+            {
+                return abandon(c, HTTP2_PROTOCOL_ERROR);
+            }
+            if (length > 0)
+            {
+                notify(c, HTTP2_WINDOW_UPDATE, 0, length);
+                if (t != NULL && (flags & HTTP2_END_STREAM) == 0)
+                {
+                    notify(c, HTTP2_WINDOW_UPDATE, id, length);
+                }
+            }
+            return true;
+
+        // gather header block, sans any padding and priority
+        case HTTP2_HEADERS:
+        {
+            size_t padding = 0;
+            if ((flags & HTTP2_PADDED) != 0 && length > 0)
+            {
+                padding = p[0];
+                p++;
+                length--;
+            }
+            if ((flags & HTTP2_PRIORITY_FLAG) != 0 && length >= 5)
+            {
+                p += 5;
+                length -= 5;
+            }
+            if (id == 0 || id % 2 == 0 || padding > length)
+            {
+                return abandon(c, HTTP2_PROTOCOL_ERROR);
+            }
+            memcpy(s->block, p, length - padding);
+            s->gathered = length - padding;
+            s->opening = id;
+            if ((flags & HTTP2_END_HEADERS) == 0)
+            {
+                s->continuing = id;
+                return true;
+            }
+            return commence(c);
+        }
+
+        // gather rest of header block
+        case HTTP2_CONTINUATION:
+            if (s->continuing == 0)
+            {
+                return abandon(c, HTTP2_PROTOCOL_ERROR);
+            }
+            if (s->gathered + length > sizeof(s->block))
+            {
+                return abandon(c, HTTP2_ENHANCE_YOUR_CALM);
+            }
+            memcpy(s->block + s->gathered, p, length);
+            s->gathered += length;
+            if ((flags & HTTP2_END_HEADERS) == 0)
+            {
+                return true;
+            }
+            s->continuing = 0;
+            return commence(c);
+
+        // ignore RFC 7540's priorities, which RFC 9113 deprecates
+        case HTTP2_PRIORITY:
+            return true;
+
+        // reprioritize a stream, per RFC 9218
+        case HTTP2_PRIORITY_UPDATE:
+        {
+            if (id != 0 || length < 4)
+            {
+                return abandon(c, HTTP2_PROTOCOL_ERROR);
+            }
+            unsigned int prioritized = ((p[0] & 0x7f) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+            for (t = s->streams; t != NULL; t = t->sibling)
+            {
+                if (t->id == prioritized)
+                {
+                    t->urgency = prioritize(payload + 4, length - 4, t->urgency);
+                }
+            }
+            return true;
+        }
+
+        // reset stream, if still open
+        case HTTP2_RST_STREAM:
+            if (id == 0 || id > s->highest)
+            {
+                return abandon(c, HTTP2_PROTOCOL_ERROR);
+            }
+            if (length != 4)
+            {
+                return abandon(c, HTTP2_FRAME_SIZE_ERROR);
+            }
+            if (t != NULL)
+            {
+                t->ended = true;
+                hangup(t);
+            }
+            return true;
+
+        // adopt and acknowledge client's settings
+        case HTTP2_SETTINGS:
+        {
+            if (id != 0)
+            {
+                return abandon(c, HTTP2_PROTOCOL_ERROR);
+            }
+            if (((flags & HTTP2_ACK) != 0 && length != 0) || length % 6 != 0)
+            {
+                return abandon(c, HTTP2_FRAME_SIZE_ERROR);
+            }
+            if ((flags & HTTP2_ACK) != 0)
+            {
+                return true;
+            }
+            unsigned int code = adopt(c, payload, length);
+            if (code != HTTP2_NO_ERROR)
+            {
+                return abandon(c, code);
+            }
+            post(c, HTTP2_SETTINGS, HTTP2_ACK, 0, NULL, 0);
+            return true;
+        }
+
+        // clients mustn't push
+        case HTTP2_PUSH_PROMISE:
+            return abandon(c, HTTP2_PROTOCOL_ERROR);
+
+        // answer pings
+        case HTTP2_PING:
+            if (id != 0)
+            {
+                return abandon(c, HTTP2_PROTOCOL_ERROR);
+            }
+            if (length != 8)
+            {
+                return abandon(c, HTTP2_FRAME_SIZE_ERROR);
+            }
+            if ((flags & HTTP2_ACK) == 0)
+            {
+                post(c, HTTP2_PING, HTTP2_ACK, 0, payload, length);
+            }
+            return true;
+
+        // open no more streams, but finish those open
+        case HTTP2_GOAWAY:
+            s->going = true;
+            return true;
+
+        // open connection's window or a stream's
+        case HTTP2_WINDOW_UPDATE:
+        {
+            if (length != 4)
+            {
+                return abandon(c, HTTP2_FRAME_SIZE_ERROR);
+            }
+            long increment = ((p[0] & 0x7f) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+            if (id == 0)
+            {
+                s->window += increment;
+                if (increment == 0 || s->window > 0x7fffffff)
+                {
+                    return abandon(c, (increment == 0) ? HTTP2_PROTOCOL_ERROR : HTTP2_FLOW_CONTROL_ERROR);
+                }
+            }
+            else if (t != NULL)
+            {
+                t->window += increment;
+                if (increment == 0 || t->window > 0x7fffffff)
+                {
+                    notify(c, HTTP2_RST_STREAM, id, (increment == 0) ? HTTP2_PROTOCOL_ERROR : HTTP2_FLOW_CONTROL_ERROR);
+                    t->ended = true;
+                    hangup(t);
+                }
+            }
+            return true;
+        }
+
+        // ignore frames of unknown types
+        default:
+            return true;
+    }
+}
+
+/**
+ * Reclaims all memory allotted from connection's arena, keeping arenas of ARENA
+ * bytes as spares (up to SPARES thereof) and freeing any others.
+ */
+void reclaim(struct connection* c)
+{
+    while (c->arena != NULL)
+    {
+        struct arena* a = c->arena;
+        c->arena = a->next;
+        if (a->size == ARENA && narenas < SPARES)
+        {
+            a->next = arenas;
+            arenas = a;
+            narenas++;
+        }
+        else
+        {
+            free(a);
+        }
+    }
+}
+
+/**
+ * Appends a FastCGI record (or, if content exceeds 65535 bytes, records) of specified
+ * type, with content of specified length, to backend's request. Returns true iff
+ * successful.
+ */
+bool record(struct backend* b, int type, const BYTE* content, size_t length)
+{
+    size_t offset = 0;
+    do
+    {
+        // header, followed by content padded to a multiple of 8 bytes
+        size_t n = (length - offset > 65535) ? 65535 : length - offset;
+        size_t padding = (8 - n % 8) % 8;
+        BYTE* request = realloc(b->request, b->size + 8 + n + padding);
+        if (request == NULL)
+        {
+            return false;
+        }
+        b->request = request;
+        unsigned char header[8] = {FCGI_VERSION_1, type, 0, 1, (n >> 8) & 0xff, n & 0xff, padding, 0};
+        memcpy(b->request + b->size, header, sizeof(header));
+        if (n > 0)
+        {
+            memcpy(b->request + b->size + 8, content + offset, n);
+        }
+        memset(b->request + b->size + 8 + n, 0, padding);
+        b->size += 8 + n + padding;
+        offset += n;
+    }
+    while (offset < length);
+    return true;
+}
+
+/**
+ * Reuses a spare connection (and its buffers), if any, else allocates a connection
+ * and its buffer for requests. Returns connection, else NULL if out of memory.
+ */
+struct connection* recruit(void)
+{
+    struct connection* c = spares;
+    if (c != NULL)
+    {
+        spares = c->next;
+        nspares--;
+        char* message = c->message;
+        BYTE* response = c->response;
+        size_t capacity = c->capacity;
+        memset(c, 0, sizeof(struct connection));
+        c->message = message;
+        c->response = response;
+        c->capacity = capacity;
+    }
+    else if ((c = calloc(1, sizeof(struct connection))) != NULL && (c->message = malloc(BUFFER)) == NULL)
+    {
+        free(c);
+        c = NULL;
+    }
+    return c;
+}
+
+/**
+ * Redirects client to uri.
+ */
+void redirect(const char* uri)
+{
+    char* template = "Location: %s\r\n";
+    char headers[strlen(template) - 2 + strlen(uri) + 1];
+    if (sprintf(headers, template, uri) < 0)
+    {
+        error(500);
+        return;
+    }
+    respond(301, headers, NULL, 0);
+}
+
+/**
+ * Relays (without blocking) client's request to backend and backend's response
+ * to client, as far as each can go. Response is buffered (and framed with
+ * Content-Length) if backend produces it all at once, else streamed to client
+ * in chunks, with reads from backend paused while a buffer's worth awaits client.
+ * Backends without clients are idle in pool, whence they're removed if closed by peer.
+ */
+void relay(struct backend* b)
+{
+    // ignore backends closed during this iteration of event loop
+    if (b->fd == -1)
+    {
+        return;
+    }
+
+    // close idle backend if peer has closed it
+    if (b->client == NULL)
+    {
+        BYTE buffer[1];
+        ssize_t bytes = read(b->fd, buffer, sizeof(buffer));
+        if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        {
+            return;
+        }
+        for (struct backend** p = &pool; *p != NULL; p = &(*p)->next)
+        {
+            if (*p == b)
+            {
+                *p = b->next;
+                pooled--;
+                break;
+            }
+        }
+        detach(b, false);
+        return;
+    }
+
+    // write as much of request as backend will accept
+    while (b->sent < b->size)
+    {
+        ssize_t bytes = write(b->fd, b->request + b->sent, b->size - b->sent);
+        if (bytes == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
+            }
+            fail(b);
+            return;
+        }
+        b->sent += bytes;
+    }
+
+    // read as much of response as backend has sent (and client can keep up with)
+    struct connection* c = b->client;
+    while (!b->streaming || c->size - c->sent < BUFFER)
+    {
+        BYTE buffer[BYTES * 16];
+        ssize_t bytes = read(b->fd, buffer, sizeof(buffer));
+        if (bytes == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            // stream whatever's been produced while script is still running
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                if (!stream(b))
+                {
+                    conclude(b, false);
+                }
+                return;
+            }
+            fail(b);
+            return;
+        }
+        if (bytes == 0)
+        {
+            fail(b);
+            return;
+        }
+        b->responded = true;
+
+        // buffer bytes until records are complete
+        BYTE* input = realloc(b->input, b->length + bytes);
+        if (input == NULL)
+        {
+            conclude(b, false);
+            return;
+        }
+        b->input = input;
+        memcpy(b->input + b->length, buffer, bytes);
+        b->length += bytes;
+
+        // parse complete records
+        size_t offset = 0;
+        while (b->length - offset >= 8)
+        {
+            const unsigned char* header = (unsigned char*) b->input + offset;
+            size_t n = (header[4] << 8) | header[5];
+            size_t total = 8 + n + header[6];
+            if (b->length - offset < total)
+            {
+                break;
+            }
+            const BYTE* content = b->input + offset + 8;
+            offset += total;
+
+            // stream script's output, once its headers have been, else buffer it
+            if (header[1] == FCGI_STDOUT && n > 0 && b->streaming)
+            {
+                if (!chunk(c, content, n))
+                {
+                    conclude(b, false);
+                    return;
+                }
+            }
+            else if (header[1] == FCGI_STDOUT && n > 0)
+            {
+                BYTE* output = realloc(b->output, b->produced + n);
+                if (output == NULL)
+                {
+                    conclude(b, false);
+                    return;
+                }
+                b->output = output;
+                memcpy(b->output + b->produced, content, n);
+                b->produced += n;
+            }
+
+            // log script's errors
+            else if (header[1] == FCGI_STDERR)
+            {
+                fwrite(content, 1, n, stderr);
+            }
+
+            // respond to client once script has ended, provided backend completed request
+            else if (header[1] == FCGI_END_REQUEST)
+            {
+                conclude(b, n >= 8 && content[4] == FCGI_REQUEST_COMPLETE);
+                return;
+            }
+        }
+        memmove(b->input, b->input + offset, b->length - offset);
+        b->length -= offset;
+
+        // stream output that's outgrown a buffer
+        if ((b->streaming || b->produced > BUFFER) && !stream(b))
+        {
+            conclude(b, false);
+            return;
+        }
+        if (b->client == NULL)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * Releases a reference to entry, freeing it once no references remain.
+ */
+void release(struct entry* e)
+{
+    e->references--;
+    if (e->references <= 0)
+    {
+        free(e->path);
+        for (int i = 0; i < CODINGS; i++)
+        {
+            free(e->headers[i]);
+            free(e->body[i]);
+        }
+        free(e);
+    }
+}
+
+/**
+ * Reloads server's configuration (i.e., MIME types and TLS certificate and key,
+ * whichever were specified) and, if root's immutable, snapshots it anew, for workers
+ * yet to be spawned. Returns true iff successful, else configuration may be only
+ * partly reloaded.
+ */
+bool reload(void)
+{
+    // thaw snapshot, whose routes and entries refer to MIME types
+    thaw();
+
+    // reload MIME types
+    if (mimetypes != NULL)
+    {
+        for (size_t i = 0; i < slots; i++)
+        {
+            free(extensions[i]);
+            free(types[i]);
+        }
+        free(extensions);
+        free(types);
+        extensions = NULL;
+        types = NULL;
+        slots = 0;
+        loaded = 0;
+        if (!extend(mimetypes))
+        {
+            return false;
+        }
+    }
+
+    // reload certificate and key, keeping those already loaded if they can't be
+    if (certificate != NULL)
+    {
+        SSL_CTX* loaded = tls;
+        if (!secure(certificate, key))
+        {
+            if (tls != loaded)
+            {
+                SSL_CTX_free(tls);
+            }
+            tls = loaded;
+            return false;
+        }
+        SSL_CTX_free(loaded);
+    }
+
+    // snapshot root anew
+    if (immutable)
+    {
+        if (!freeze(root) || !bundle())
+        {
+            thaw();
+            return false;
+        }
+        printf("\033[33m");
+        printf("Snapshotted %zu paths beneath server's root", snapshotted);
+        printf("\033[39m\n");
+    }
+    return true;
+}
+
+/**
+ * Remembers field (names bytes of name, followed by values bytes of value) as newest
+ * in HTTP/2 connection's table, evicting oldest fields to make room for it, unless it's
+ * larger than table itself, in which case table is merely emptied.
+ * https://tools.ietf.org/html/rfc7541#section-4.4
+ */
+void remember(struct session* s, const char* field, size_t names, size_t values)
+{
+    size_t size = names + values + 32;
+    if (size > s->limit)
+    {
+        shrink(s, 0);
+        return;
+    }
+    shrink(s, s->limit - size);
+
+    // append field's bytes to ring, after newest field's
+    size_t offset = 0;
+    if (s->nfields > 0)
+    {
+        const struct field* newest = &s->fields[(s->oldest + s->nfields - 1) % (TABLE / 32)];
+        offset = (newest->offset + newest->name + newest->value) % TABLE;
+    }
+    size_t n = names + values, first = (n < TABLE - offset) ? n : TABLE - offset;
+    memcpy(s->bytes + offset, field, first);
+    memcpy(s->bytes, field + first, n - first);
+    struct field* f = &s->fields[(s->oldest + s->nfields) % (TABLE / 32)];
+    f->offset = offset;
+    f->name = names;
+    f->value = values;
+    s->nfields++;
+    s->size += size;
+}
+
+/**
+ * Renders Status-Line and error page of every status code with a reason phrase,
+ * so that responses needn't be formatted anew. Returns true iff successful.
+ */
+bool render(void)
+{
+    for (int code = 100; code < (int) (sizeof(statuses) / sizeof(statuses[0])); code++)
+    {
+        const char* phrase = reason(code);
+        if (phrase == NULL)
+        {
+            continue;
+        }
+        struct status* s = &statuses[code];
+        const char* template = "<html><head><title>%i %s</title></head><body><h1>%i %s</h1></body></html>";
+        int n = snprintf(NULL, 0, "HTTP/1.1 %i %s\r\n", code, phrase);
+        int m = snprintf(NULL, 0, template, code, phrase, code, phrase);
+        if (n < 0 || m < 0 || (s->line = malloc(n + 1)) == NULL || (s->page = malloc(m + 1)) == NULL)
+        {
+            return false;
+        }
+        s->length = sprintf(s->line, "HTTP/1.1 %i %s\r\n", code, phrase);
+        s->size = sprintf(s->page, template, code, phrase, code, phrase);
+    }
+    return true;
+}
+
+/**
+ * Responds to client with a script's output, per CGI, whose headers (e.g., Status)
+ * are translated into HTTP's, with whatever of body has been output thus far
+ * followed by the rest in chunks, if chunked. Returns true iff successful.
+ *
+ * https://tools.ietf.org/html/rfc3875#section-6
+ */
+bool reply(const BYTE* output, size_t length, bool chunked)
+{
+    // find end of script's headers
+    const BYTE* body = split(output, length);
+    if (body == NULL)
+    {
+        return false;
+    }
+
+    // translate headers into HTTP's, at most doubling their length
+    int code = 0;
+    bool located = false;
+    char headers[(body - output) * 2 + 1];
+    size_t n = 0;
+    for (const BYTE* line = output; line < body; )
+    {
+        const BYTE* end = memchr(line, '\n', body - line);
+        size_t m = end - line;
+        if (m > 0 && line[m - 1] == '\r')
+        {
+            m--;
+        }
+        if (m > 0)
+        {
+            // status code, which isn't itself a header
+            if (strncasecmp(line, "Status:", strlen("Status:")) == 0)
+            {
+                code = atoi(line + strlen("Status:"));
+            }
+
+            // let server alone determine framing of body and persistence of connection
+            else if (strncasecmp(line, "Content-Length:", strlen("Content-Length:")) != 0
+                && strncasecmp(line, "Transfer-Encoding:", strlen("Transfer-Encoding:")) != 0
+                && strncasecmp(line, "Connection:", strlen("Connection:")) != 0)
+            {
+                located = located || strncasecmp(line, "Location:", strlen("Location:")) == 0;
+                memcpy(headers + n, line, m);
+                memcpy(headers + n + m, "\r\n", 2);
+                n += m + 2;
+            }
+        }
+        line = end + 1;
+    }
+    headers[n] = '\0';
+
+    // redirect if script specified location but not status
+    if (code == 0)
+    {
+        code = located ? 302 : 200;
+    }
+    if (!chunked)
+    {
+        return respond(code, headers, body, output + length - body);
+    }
+    if (!respond(code, headers, NULL, CHUNKED))
+    {
+        return false;
+    }
+    return (output + length == body) || chunk(client, body, output + length - body);
+}
+
+/**
+ * Responds to client with headers for a representation of length bytes and MIME type
+ * type, whose entity-tag is etag and which was last modified at mtime, whose body (as
+ * entry's or file's) client already holds: with 304 if client's copy is fresh, else with
+ * 206 if client asks for ranges of it (or 416 if none is satisfiable), else with 200.
+ * Detaches body from client unless it's to follow. Returns status code, else 0 on error.
+ */
+int represent(const char* headers, const char* type, off_t length, const char* etag, time_t mtime)
+{
+    int code = 0;
+    struct range* ranges = NULL;
+    int parts = 0;
+    if (fresh(etag, mtime))
+    {
+        code = respond(304, headers, NULL, 0) ? 304 : 0;
+    }
+    else if ((parts = partition(length, etag, mtime, &ranges)) == 0)
+    {
+        code = respond(200, headers, NULL, length) ? 200 : 0;
+    }
+    else if (parts == -1)
+    {
+        char range[BYTES / 4];
+        snprintf(range, sizeof(range), "Content-Range: bytes */%lld\r\n", (long long) length);
+        code = respond(416, range, NULL, 0) ? 416 : 0;
+    }
+    else
+    {
+        client->ranges = ranges;
+        client->parts = parts;
+        client->part = 0;
+        client->total = length;
+        client->type = type;
+
+        // respond with single range, its headers alongside representation's
+        char* h = NULL;
+        size_t size = 0;
+        int n = -1;
+        if (parts == 1)
+        {
+            n = snprintf(NULL, 0, "%sContent-Range: bytes %lld-%lld/%lld\r\n", headers,
+                (long long) ranges[0].first, (long long) ranges[0].last, (long long) length);
+            h = (n < 0) ? NULL : allot(client, n + 1);
+            if (h != NULL)
+            {
+                sprintf(h, "%sContent-Range: bytes %lld-%lld/%lld\r\n", headers,
+                    (long long) ranges[0].first, (long long) ranges[0].last, (long long) length);
+                size = ranges[0].last - ranges[0].first + 1;
+            }
+        }
+
+        // else with multiple ranges, as parts, whose headers replace representation's
+        // Content-Type (which label puts first)
+        else
+        {
+            if (boundary[0] == '\0')
+            {
+                snprintf(boundary, sizeof(boundary), "%08lx%08lx", (unsigned long) getpid(), (unsigned long) now());
+            }
+            const char* rest = strstr(headers, "\r\n");
+            rest = (rest != NULL) ? rest + 2 : headers;
+            n = snprintf(NULL, 0, "Content-Type: multipart/byteranges; boundary=%s\r\n%s", boundary, rest);
+            h = (n < 0) ? NULL : allot(client, n + 1);
+            if (h != NULL)
+            {
+                sprintf(h, "Content-Type: multipart/byteranges; boundary=%s\r\n%s", boundary, rest);
+                for (int i = 0; i <= parts; i++)
+                {
+                    size += delimit(NULL, 0, client, i);
+                    if (i < parts)
+                    {
+                        size += ranges[i].last - ranges[i].first + 1;
+                    }
+                }
+            }
+        }
+        code = (h != NULL && respond(206, h, NULL, size) && excerpt(client)) ? 206 : 0;
+    }
+
+    // detach body unless it's to follow
+    if (code != 200 && code != 206)
+    {
+        if (client->entry != NULL)
+        {
+            release(client->entry);
+            client->entry = NULL;
+        }
+        if (client->file != -1)
+        {
+            close(client->file);
+            client->file = -1;
+        }
+    }
+    return code;
+}
+
+/**
+ * Renders Date and Server headers anew, if a second or more has passed since last
+ * rendered, so that responses merely copy them.
+ * https://tools.ietf.org/html/rfc7231#section-7.1.1.2
+ */
+void restamp(void)
+{
+    time_t t = time(NULL);
+    if (t == dated)
+    {
+        return;
+    }
+    struct tm tm;
+    char date[BYTES / 8];
+    if (gmtime_r(&t, &tm) == NULL || strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm) == 0)
+    {
+        return;
+    }
+    stamped = snprintf(stamp, sizeof(stamp), "Date: %s\r\nServer: WebServerC\r\n", date);
+    dated = t;
+}
+
+/**
+ * Responds to (current) client with file that job has opened (and, if small enough
+ * to cache, loaded), caching it if possible, then frees job.
+ */
+void resume(struct job* j)
+{
+    measure(client, IO, nanotime() - j->began);
+
+    // respond with error if file couldn't be opened
+    if (j->file == -1 || j->error != 0)
+    {
+        error((j->error == EACCES) ? 403 : (j->error == ENOENT) ? 404 : 500);
+    }
+
+    // respond from cache, if file has since been cached (by another job), else cache
+    // file's content, if loaded, so that later requests needn't touch file
+    else
+    {
+        struct entry* e = cached(j->path);
+        if (e == NULL && j->body != NULL)
+        {
+            e = cache(j->path, &j->sb, j->type, j->body, j->length);
+            if (e != NULL)
+            {
+                j->body = NULL;
+            }
+        }
+        if (e != NULL)
+        {
+            deliver(e);
+        }
+        else
+        {
+            // respond with file's content (or ranges thereof) straight from page cache
+            // (else from file's precompressed sibling), whereupon client owns file
+            ship(j->path, j->type, j->file, &j->sb);
+            j->file = -1;
+        }
+    }
+
+    // free job
+    if (j->file != -1)
+    {
+        close(j->file);
+    }
+    free(j->body);
+    free(j->path);
+    free(j);
+}
+
+/**
+ * Reads (without blocking) whatever bytes client has sent of an HTTP request's headers
+ * into connection's buffer, parsing them in a single pass (incrementally, as they
+ * arrive) into slices of buffer, unless buffer already holds them, having been
+ * pipelined after a previous request. Returns true iff the request's headers have
+ * been read in their entirety (or found invalid, in which case parsed.invalid is
+ * the status code with which to reject request), else false, in which case
+ * connection is marked as closing if client has hung up.
+ */
+bool request(struct connection* c)
+{
+    struct headers* h = &c->parsed;
+    while (true)
+    {
+        // parse as many lines as have been read in their entirety
+        const char* lf;
+        while ((lf = find(c->message + h->scanned, c->length - h->scanned, '\n')) != NULL)
+        {
+            // ensure line ends with CRLF
+            size_t end = lf - c->message;
+            h->scanned = end + 1;
+            if (end == h->line || c->message[end - 1] != '\r')
+            {
+                h->invalid = 400;
+                return true;
+            }
+            const char* line = c->message + h->line;
+            size_t length = end - 1 - h->line;
+            h->line = end + 1;
+
+            // ignore any empty lines before request-line
+            // https://tools.ietf.org/html/rfc7230#section-3.5
+            if (length == 0 && h->request.length == 0)
+            {
+                continue;
+            }
+
+            // found end of headers, after which any bytes are pipelined
+            if (length == 0)
+            {
+                h->end = end + 1;
+                return true;
+            }
+
+            // ensure request-line is no longer than LimitRequestLine
+            if (h->request.length == 0)
+            {
+                if (length + 2 > LimitRequestLine)
+                {
+                    h->invalid = 414;
+                    return true;
+                }
+                h->request.start = line - c->message;
+                h->request.length = length;
+                continue;
+            }
+
+            // ensure field is no longer than LimitRequestFieldSize and that message
+            // has no more than LimitRequestFields
+            if (length + 2 > LimitRequestFieldSize || h->fields == LimitRequestFields)
+            {
+                h->invalid = 400;
+                return true;
+            }
+
+            // ensure field has a name, sans whitespace, followed by a colon
+            // https://tools.ietf.org/html/rfc7230#section-3.2.4
+            const char* colon = find(line, length, ':');
+            if (colon == NULL || colon == line || colon[-1] == ' ' || colon[-1] == '\t'
+                || line[0] == ' ' || line[0] == '\t')
+            {
+                h->invalid = 400;
+                return true;
+            }
+
+            // trim whitespace around value
+            const char* value = colon + 1;
+            const char* last = line + length;
+            while (value < last && (*value == ' ' || *value == '\t'))
+            {
+                value++;
+            }
+            while (last > value && (last[-1] == ' ' || last[-1] == '\t'))
+            {
+                last--;
+            }
+
+            // remember field
+            h->names[h->fields].start = line - c->message;
+            h->names[h->fields].length = colon - line;
+            h->values[h->fields].start = value - c->message;
+            h->values[h->fields].length = last - value;
+            h->fields++;
+        }
+        h->scanned = c->length;
+
+        // ensure headers fit in buffer
+        if (c->length == BUFFER)
+        {
+            h->invalid = (h->request.length == 0) ? 414 : 400;
+            return true;
+        }
+
+        // read from socket
+        ssize_t bytes = pull(c, c->message + c->length, BUFFER - c->length);
+        if (bytes == -1 && errno == EINTR)
+        {
+            continue;
+        }
+
+        // wait for client to send more
+        if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return false;
+        }
+
+        // client hung up or erred
+        if (bytes <= 0)
+        {
+            c->state = CLOSING;
+            return false;
+        }
+        c->length += bytes;
+    }
+}
+
+/**
+ * Resolves path to what's to be served, from cache if possible (without touching
+ * file system). Routes are cached only if inotify can watch for changes to them
+ * (and to their ancestors), else they're to be freed (by forget) after use.
+ * Returns route, else NULL if out of memory.
+ */
+struct route* resolve(const char* path)
+{
+    // search snapshot (if root's frozen), then cache
+    unsigned long h = hash(path);
+    struct route* s = frozen ? locate(path) : NULL;
+    if (s != NULL)
+    {
+        tally(&meter->routed, 1);
+        return s;
+    }
+    if (routes != NULL)
+    {
+        for (struct route* r = routes[h & (CacheRoutes - 1)]; r != NULL; r = r->chain)
+        {
+            if (r->hash == h && strcmp(r->path, path) == 0)
+            {
+                tally(&meter->routed, 1);
+                return r;
+            }
+        }
+    }
+    tally(&meter->unrouted, 1);
+
+    // resolve path anew
+    struct route* r = calloc(1, sizeof(struct route));
+    if (r == NULL || (r->path = strdup(path)) == NULL)
+    {
+        free(r);
+        return NULL;
+    }
+    r->hash = h;
+    struct stat sb;
+    if (frozen)
+    {
+        // nothing beneath a frozen root is missing from snapshot
+        r->target = NOTHING;
+        return r;
+    }
+    if (stat(path, &sb) == -1)
+    {
+        r->target = NOTHING;
+    }
+    else if (!S_ISDIR(sb.st_mode))
+    {
+        r->target = REGULAR;
+        r->file = strdup(path);
+    }
+
+    // redirect from directory to directory/
+    else if (path[strlen(path) - 1] != '/')
+    {
+        r->target = RELOCATION;
+    }
+
+    // use directory/index.php or directory/index.html, if present, else list directory
+    else
+    {
+        r->file = indexes(path);
+        r->target = (r->file != NULL) ? REGULAR : LISTING;
+    }
+    if (r->target == REGULAR)
+    {
+        if (r->file == NULL)
+        {
+            forget(r);
+            return NULL;
+        }
+        r->type = lookup(r->file);
+    }
+
+    // find deepest part of path that exists, whose directory is to be watched
+    char existing[strlen(path) + 1];
+    strcpy(existing, path);
+    char* slash;
+    while (r->target == NOTHING && access(existing, F_OK) == -1
+        && (slash = strrchr(existing, '/')) != NULL)
+    {
+        *slash = '\0';
+    }
+    size_t n = strlen(existing);
+    while (n > 1 && existing[n - 1] == '/')
+    {
+        existing[--n] = '\0';
+    }
+
+    // cache route, unless path traverses a symbolic link (whose target could be
+    // anywhere) or inotify can't watch path's directory (and ancestors)
+    char* real = realpath(existing, NULL);
+    bool watchable = (real != NULL && strcmp(real, existing) == 0);
+    free(real);
+    if (watchable && r->target == NOTHING)
+    {
+        strcat(existing, "/");
+        watchable = observe(existing);
+    }
+    else if (watchable)
+    {
+        watchable = observe(path);
+    }
+    if (!watchable)
+    {
+        return r;
+    }
+
+    // start cache over once full
+    if (routed >= CacheRoutes)
+    {
+        unroute(NULL, true);
+    }
+    if (routes == NULL && (routes = calloc(CacheRoutes, sizeof(struct route*))) == NULL)
+    {
+        return r;
+    }
+    r->chain = routes[h & (CacheRoutes - 1)];
+    routes[h & (CacheRoutes - 1)] = r;
+    r->cached = true;
+    routed++;
+    return r;
+}
+
+/**
+ * Responds to a client with status code, headers, and body of specified length.
+ * If body is NULL, length bytes of body are instead to follow (e.g., from a file).
+ * Returns true iff response has been queued.
+ */
+bool respond(int code, const char* headers, const char* body, size_t length)
+{
+    // ensure code has a Status-Line and there's a client to respond to
+    // http://www.w3.org/Protocols/rfc2616/rfc2616-sec6.html#sec6.1
+    if (code < 0 || code >= (int) (sizeof(statuses) / sizeof(statuses[0])) || statuses[code].line == NULL
+        || client == NULL)
+    {
+        return false;
+    }
+
+    // frame body with Content-Length (or in chunks, if its length is unknown) so that
+    // connection can persist, unless response (e.g., 304) can't have a body
+    // https://tools.ietf.org/html/rfc7230#section-3.3.3
+    char framing[BYTES / 8];
+    size_t m = 0;
+    if (code == 304)
+    {
+        length = 0;
+    }
+    else if (length == CHUNKED)
+    {
+        m = strlen("Transfer-Encoding: chunked\r\n");
+        memcpy(framing, "Transfer-Encoding: chunked\r\n", m);
+    }
+    else
+    {
+        // render length's digits backward, from end of buffer
+        char digits[BYTES / 16];
+        size_t d = sizeof(digits);
+        size_t l = length;
+        do
+        {
+            digits[--d] = '0' + l % 10;
+            l /= 10;
+        }
+        while (l > 0);
+        m = strlen("Content-Length: ");
+        memcpy(framing, "Content-Length: ", m);
+        memcpy(framing + m, digits + d, sizeof(digits) - d);
+        m += sizeof(digits) - d;
+        memcpy(framing + m, "\r\n", 2);
+        m += 2;
+    }
+    const char* connection = client->keepalive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    size_t h = strlen(headers), c = strlen(connection);
+    size_t n = statuses[code].length + stamped + h + m + c;
+
+    // make room for response after any already queued
+    if (!grow(client, n + ((body != NULL) ? length : 0)))
+    {
+        return false;
+    }
+
+    // queue Status-Line, Date and Server, headers, framing, and CRLF, all pre-rendered
+    // http://www.w3.org/Protocols/rfc2616/rfc2616-sec6.html
+    BYTE* p = client->response + client->size;
+    memcpy(p, statuses[code].line, statuses[code].length);
+    p += statuses[code].length;
+    memcpy(p, stamp, stamped);
+    p += stamped;
+    memcpy(p, headers, h);
+    p += h;
+    memcpy(p, framing, m);
+    p += m;
+    memcpy(p, connection, c);
+    client->size += n;
+    client->code = code;
+    tally(&meter->responses[code], 1);
+
+    // queue body
+    if (body != NULL && length > 0)
+    {
+        memcpy(client->response + client->size, body, length);
+        client->size += length;
+    }
+    return true;
+}
+
+/**
+ * Keeps closed connection (with its buffers) as a spare, unless SPARES are kept
+ * already, in which case it's freed.
+ */
+void retire(struct connection* c)
+{
+    free(c->session);
+    c->session = NULL;
+    if (nspares < SPARES)
+    {
+        c->next = spares;
+        spares = c;
+        nspares++;
+    }
+    else
+    {
+        free(c->message);
+        free(c->response);
+        free(c);
+    }
+}
+
+/**
+ * Finds first occurrence of any character in set among the n bytes at s, comparing
+ * 32 (with AVX2) or 16 (with SSE2) bytes at a time against each of set's characters.
+ * Returns pointer thereto, else NULL.
+ */
+const char* scan(const char* s, size_t n, const char* set)
+{
+    size_t i = 0, k = strlen(set);
+#if defined(__AVX2__)
+    __m256i needles[k];
+    for (size_t j = 0; j < k; j++)
+    {
+        needles[j] = _mm256_set1_epi8(set[j]);
+    }
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i haystack = _mm256_loadu_si256((const __m256i*) (s + i));
+        __m256i matches = _mm256_setzero_si256();
+        for (size_t j = 0; j < k; j++)
+        {
+            matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(haystack, needles[j]));
+        }
+        unsigned int mask = _mm256_movemask_epi8(matches);
+        if (mask != 0)
+        {
+            return s + i + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i needle[k];
+    for (size_t j = 0; j < k; j++)
+    {
+        needle[j] = _mm_set1_epi8(set[j]);
+    }
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i haystack = _mm_loadu_si128((const __m128i*) (s + i));
+        __m128i matches = _mm_setzero_si128();
+        for (size_t j = 0; j < k; j++)
+        {
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi8(haystack, needle[j]));
+        }
+        unsigned int mask = _mm_movemask_epi8(matches);
+        if (mask != 0)
+        {
+            return s + i + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; i < n; i++)
+    {
+        for (size_t j = 0; j < k; j++)
+        {
+            if (s[i] == set[j])
+            {
+                return s + i;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Responds to client with all processes' metrics, merged, in Prometheus's text format.
+ * https://prometheus.io/docs/instrumenting/exposition_formats/
+ */
+void scrape(void)
+{
+    // sum processes' metrics word by word
+    struct metrics total;
+    memset(&total, 0, sizeof(total));
+    unsigned long long* sum = (unsigned long long*) &total;
+    for (int i = 0; i < nmeters; i++)
+    {
+        const unsigned long long* m = (const unsigned long long*) &meters[i];
+        for (size_t j = 0; j < sizeof(struct metrics) / sizeof(unsigned long long); j++)
+        {
+            sum[j] += __atomic_load_n(&m[j], __ATOMIC_RELAXED);
+        }
+    }
+
+    // render counters and gauges, one line at a time
+    char* text = NULL;
+    size_t length = 0, capacity = 0;
+    char line[BYTES * 4];
+    const char* help = "# HELP server_responses_total Responses sent, by status code.\n"
+        "# TYPE server_responses_total counter\n";
+    bool ok = append(&text, &length, &capacity, help, strlen(help));
+    for (size_t i = 0; i < sizeof(total.responses) / sizeof(total.responses[0]) && ok; i++)
+    {
+        if (total.responses[i] > 0)
+        {
+            int n = snprintf(line, sizeof(line), "server_responses_total{code=\"%zu\"} %llu\n", i, total.responses[i]);
+            ok = append(&text, &length, &capacity, line, n);
+        }
+    }
+    double files = (total.hits + total.misses > 0) ? (double) total.hits / (total.hits + total.misses) : 0;
+    double routes = (total.routed + total.unrouted > 0) ? (double) total.routed / (total.routed + total.unrouted) : 0;
+    int n = snprintf(line, sizeof(line),
+        "# HELP server_sent_bytes_total Bytes sent to clients.\n"
+        "# TYPE server_sent_bytes_total counter\n"
+        "server_sent_bytes_total %llu\n"
+        "# HELP server_connections Connections open.\n"
+        "# TYPE server_connections gauge\n"
+        "server_connections %llu\n"
+        "# HELP server_connections_refused_total Connections refused, for want of room.\n"
+        "# TYPE server_connections_refused_total counter\n"
+        "server_connections_refused_total %llu\n"
+        "# HELP server_connections_expired_total Connections closed for passing their deadlines.\n"
+        "# TYPE server_connections_expired_total counter\n"
+        "server_connections_expired_total %llu\n"
+        "# HELP server_cache_hits_total Hits of caches, by cache.\n"
+        "# TYPE server_cache_hits_total counter\n"
+        "server_cache_hits_total{cache=\"files\"} %llu\n"
+        "server_cache_hits_total{cache=\"routes\"} %llu\n"
+        "# HELP server_cache_misses_total Misses of caches, by cache.\n"
+        "# TYPE server_cache_misses_total counter\n"
+        "server_cache_misses_total{cache=\"files\"} %llu\n"
+        "server_cache_misses_total{cache=\"routes\"} %llu\n"
+        "# HELP server_cache_hit_ratio Ratio of hits to lookups of caches, by cache.\n"
+        "# TYPE server_cache_hit_ratio gauge\n"
+        "server_cache_hit_ratio{cache=\"files\"} %.4f\n"
+        "server_cache_hit_ratio{cache=\"routes\"} %.4f\n"
+        "# HELP server_log_dropped_total Requests dropped from access log, for want of room.\n"
+        "# TYPE server_log_dropped_total counter\n"
+        "server_log_dropped_total %llu\n",
+        total.sent, total.connections, total.refused, total.expired, total.hits, total.routed, total.misses, total.unrouted, files, routes,
+        total.dropped);
+    ok = ok && n < (int) sizeof(line) && append(&text, &length, &capacity, line, n);
+
+    // render stages' histograms, with cumulative buckets (bounded in seconds) up
+    // through highest occupied one, beyond which each would only repeat +Inf's
+    help = "# HELP server_stage_seconds Latencies of stages of requests' handling.\n"
+        "# TYPE server_stage_seconds histogram\n";
+    ok = ok && append(&text, &length, &capacity, help, strlen(help));
+    for (int s = 0; s < STAGES && ok; s++)
+    {
+        int highest = BUCKETS - 1;
+        while (highest > 0 && total.latencies[s][highest] == 0)
+        {
+            highest--;
+        }
+        unsigned long long count = 0;
+        for (int i = 0; i <= highest && ok; i++)
+        {
+            // bucket i holds latencies below its upper bound
+            long long bound = i + 1;
+            if (i >= SUBBUCKETS)
+            {
+                int shift = i / SUBBUCKETS - 1;
+                bound = (long long) (SUBBUCKETS + i % SUBBUCKETS + 1) << shift;
+            }
+            count += total.latencies[s][i];
+            n = snprintf(line, sizeof(line), "server_stage_seconds_bucket{stage=\"%s\",le=\"%.9g\"} %llu\n",
+                stages[s], (bound - 1) / 1e9, count);
+            ok = append(&text, &length, &capacity, line, n);
+        }
+        n = snprintf(line, sizeof(line),
+            "server_stage_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %llu\n"
+            "server_stage_seconds_sum{stage=\"%s\"} %.9f\n"
+            "server_stage_seconds_count{stage=\"%s\"} %llu\n",
+            stages[s], count, stages[s], total.sums[s] / 1e9, stages[s], count);
+        ok = ok && append(&text, &length, &capacity, line, n);
+    }
+
+    // respond with metrics
+    if (!ok)
+    {
+        free(text);
+        error(500);
+        return;
+    }
+    respond(200, "Content-Type: text/plain; version=0.0.4\r\nCache-Control: no-store\r\n", text, length);
+    free(text);
+}
+
+/**
+ * Writes access log's notes, as they're jotted, in batches every PERIOD milliseconds.
+ */
+void* scribe(void* arg)
+{
+    while (true)
+    {
+        struct timespec ts = {PERIOD / 1000, (PERIOD % 1000) * 1000000L};
+        nanosleep(&ts, NULL);
+        pthread_mutex_lock(&logging);
+        drain();
+        pthread_mutex_unlock(&logging);
+    }
+    return NULL;
+}
+
+/**
+ * Prepares to serve HTTPS with certificate chain and private key (in PEM files, which
+ * may be one and the same), negotiating HTTP/2 or HTTP/1.1 via ALPN, resuming sessions
+ * via tickets (whose keys workers share, since they're spawned after), and letting
+ * kernel take over encryption (kTLS), if it can, once each handshake is done, so that
+ * files can still be sent straight from page cache. Returns true iff successful.
+ * https://tools.ietf.org/html/rfc8446#section-2.2
+ * https://docs.kernel.org/networking/tls-offload.html
+ */
+bool secure(const char* certificate, const char* key)
+{
+    tls = SSL_CTX_new(TLS_server_method());
+    if (tls == NULL)
+    {
+        ERR_print_errors_fp(stderr);
+        return false;
+    }
+    SSL_CTX_set_min_proto_version(tls, TLS1_2_VERSION);
+
+    // offload encryption to kernel, and refuse renegotiation (with which a client
+    // could make server redo a handshake's work at will)
+    SSL_CTX_set_options(tls, SSL_OP_ENABLE_KTLS | SSL_OP_NO_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE);
+
+    // let writes be partial (as write's are) and be retried from buffers that
+    // have since moved (as transmit compacts them), and free idle connections' buffers
+    SSL_CTX_set_mode(tls, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER
+        | SSL_MODE_RELEASE_BUFFERS);
+
+    // resume sessions (via tickets, else, for TLS 1.2 clients without them, via each
+    // worker's cache), but accept no early data, since 0-RTT requests can be replayed
+    // https://tools.ietf.org/html/rfc8446#section-8
+    SSL_CTX_set_session_cache_mode(tls, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_max_early_data(tls, 0);
+
+    // negotiate HTTP/2 or HTTP/1.1
+    SSL_CTX_set_alpn_select_cb(tls, choose, NULL);
+
+    // load certificate chain and key
+    if (SSL_CTX_use_certificate_chain_file(tls, certificate) != 1
+        || SSL_CTX_use_PrivateKey_file(tls, key, SSL_FILETYPE_PEM) != 1 || SSL_CTX_check_private_key(tls) != 1)
+    {
+        ERR_print_errors_fp(stderr);
+        errno = EINVAL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Serves connection's request, whose headers have been parsed already, queuing a response.
+ */
+void serve(const struct connection* c)
+{
+    // close connection if client asks, or if request has a body, which isn't read
+    size_t n;
+    const char* value = header(c, "Connection", &n);
+    if ((value != NULL && n == 5 && strncasecmp(value, "close", 5) == 0)
+        || header(c, "Content-Length", &n) != NULL
+        || header(c, "Transfer-Encoding", &n) != NULL)
+    {
+        client->keepalive = false;
+    }
+
+    // determine which content-codings client accepts
+    value = header(c, "Accept-Encoding", &n);
+    client->accepts = (value != NULL) ? negotiate(value, n) : 0;
+
+    // parse request-line
+    char abs_path[LimitRequestLine + 1];
+    char query[LimitRequestLine + 1];
+    if (!parse(c, abs_path, query))
+    {
+        return;
+    }
+
+    // report metrics of all processes
+    if (strcmp(abs_path, "/__metrics") == 0)
+    {
+        scrape();
+        return;
+    }
+
+    // resolve absolute-path, URL-decoded, to local path
+    char* path = allot(client, strlen(root) + strlen(abs_path) + 1);
+    if (path == NULL)
+    {
+        error(500);
+        return;
+    }
+    strcpy(path, root);
+    size_t m = urldecode(abs_path, strlen(abs_path), path + strlen(root));
+
+    // forbid any path beyond root
+    if (traverses(path + strlen(root), m))
+    {
+        error(400);
+        return;
+    }
+
+    // respond from cache, if possible, without touching file system
+    long long t = nanotime();
+    struct entry* e = cached(path);
+    if (e != NULL)
+    {
+        tally(&meter->hits, 1);
+        measure(client, RESOLVE, nanotime() - t);
+        deliver(e);
+        return;
+    }
+    tally(&meter->misses, 1);
+
+    // resolve path (from cache, if possible, without touching file system)
+    struct route* r = resolve(path);
+    measure(client, RESOLVE, nanotime() - t);
+    if (r == NULL)
+    {
+        error(500);
+        return;
+    }
+    switch (r->target)
+    {
+        // file at path (or directory's index) doesn't exist
+        case NOTHING:
+            error(404);
+            break;
+
+        // redirect from absolute-path to absolute-path/
+        case RELOCATION:
+        {
+            char uri[strlen(abs_path) + 1 + 1];
+            strcpy(uri, abs_path);
+            strcat(uri, "/");
+            redirect(uri);
+            break;
+        }
+
+        // list contents of directory
+        case LISTING:
+            list(r->path);
+            break;
+
+        // respond with file (or directory's index), interpreting PHP files
+        case REGULAR:
+            if (r->type == NULL)
+            {
+                error(501);
+            }
+            else if (strcasecmp("text/x-php", r->type) == 0)
+            {
+                interpret(r->file, query);
+            }
+            else if ((e = cached(r->file)) != NULL)
+            {
+                deliver(e);
+            }
+            else
+            {
+                transfer(r->file, r->type);
+            }
+            break;
+    }
+    forget(r);
+}
+
+/**
+ * Responds to client with file at path, whose MIME type is type, an open descriptor
+ * for which is file (which client then owns), and whose metadata is sb, its content
+ * (or ranges thereof) to be sent straight from page cache, so that memory used doesn't
+ * grow with file's length.
+ */
+void ship(const char* path, const char* type, int file, const struct stat* sb)
+{
+    // send instead file's precompressed sibling (e.g., path.br), if any,
+    // in client's most preferred coding
+    // (whose validators derive from file's own, so as to change with file)
+    enum coding coding = IDENTITY;
+    off_t length = sb->st_size;
+    for (int i = CODINGS - 1; i > IDENTITY && coding == IDENTITY && compressible(type); i--)
+    {
+        struct stat ssb;
+        int f = (client->accepts & (1 << i)) ? sibling(path, i, &ssb) : -1;
+        if (f != -1)
+        {
+            close(file);
+            file = f;
+            length = ssb.st_size;
+            coding = i;
+        }
+    }
+
+    // prepare response
+    char etag[BYTES / 4];
+    int n = label(NULL, 0, type, coding, sb);
+    char headers[(n > 0) ? n + 1 : 1];
+    if (n < 0 || label(headers, sizeof(headers), type, coding, sb) < 0
+        || tag(etag, sizeof(etag), sb, coding) < 0)
+    {
+        close(file);
+        error(500);
+        return;
+    }
+
+    // respond with headers (unless client's copy is fresh), after which file's content
+    // (or ranges thereof) is to follow
+    client->file = file;
+    client->offset = 0;
+    client->remaining = length;
+    represent(headers, type, length, etag, sb->st_mtime);
+}
+
+/**
+ * Evicts oldest fields from HTTP/2 connection's table until its size is no more than size.
+ * https://tools.ietf.org/html/rfc7541#section-4.3
+ */
+void shrink(struct session* s, size_t size)
+{
+    while (s->size > size && s->nfields > 0)
+    {
+        const struct field* f = &s->fields[s->oldest];
+        s->size -= f->name + f->value + 32;
+        s->oldest = (s->oldest + 1) % (TABLE / 32);
+        s->nfields--;
+    }
+}
+
+/**
+ * Opens path's precompressed sibling in coding (e.g., path.br), if it's a regular
+ * file, storing its metadata in sb. Returns its descriptor, else -1.
+ */
+int sibling(const char* path, enum coding coding, struct stat* sb)
+{
+    // directories (as listed) have no siblings
+    size_t n = strlen(path);
+    if (coding == IDENTITY || n == 0 || path[n - 1] == '/')
+    {
+        return -1;
+    }
+    char s[n + strlen(suffixes[coding]) + 1];
+    strcpy(s, path);
+    strcat(s, suffixes[coding]);
+    int file = open(s, O_RDONLY | O_CLOEXEC);
+    if (file == -1)
+    {
+        return -1;
+    }
+    if (fstat(file, sb) == -1 || !S_ISREG(sb->st_mode))
+    {
+        close(file);
+        return -1;
+    }
+    return file;
+}
+
+/**
+ * Forks worker, which serves connections on its own socket and, optionally,
+ * is pinned to one CPU. Returns true in worker, false in parent.
+ */
+bool spawn(int worker, bool pin)
+{
+    // don't let worker inherit (and thus repeat) parent's buffered output
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        return false;
+    }
+
+    // remember worker in parent
+    if (pid > 0)
+    {
+        pids[worker] = pid;
+        return false;
+    }
+
+    // handle signals as they arrive (unlike parent, which waits for them), leaving
+    // SIGHUP and SIGUSR2 (including any being handled) to parent
+    reloading = upgrading = false;
+    sigset_t set;
+    sigemptyset(&set);
+    sigprocmask(SIG_SETMASK, &set, NULL);
+    struct sigaction ign;
+    ign.sa_handler = SIG_IGN;
+    ign.sa_flags = 0;
+    sigemptyset(&ign.sa_mask);
+    sigaction(SIGHUP, &ign, NULL);
+    sigaction(SIGUSR2, &ign, NULL);
+
+    // keep only worker's own sockets, leaving any unix sockets for parent to remove
+    // (and predecessor, if any, for parent to tell of them)
+    if (ancestor != -1)
+    {
+        close(ancestor);
+        ancestor = -1;
+    }
+    for (int i = 0; i < workers * nendpoints; i++)
+    {
+        if (i / nendpoints != worker)
+        {
+            close(sockets[i]);
+        }
+    }
+    for (int i = 0; i < nendpoints; i++)
+    {
+        endpoints[i].fd = sockets[worker * nendpoints + i];
+        endpoints[i].path = NULL;
+    }
+    php = 0;
+    free(sockets);
+    sockets = NULL;
+    free(pids);
+    pids = NULL;
+    workers = 0;
+
+    // record metrics as worker's own
+    meter = &meters[worker];
+
+#ifdef __linux__
+    // pin worker to a CPU of its own (modulo number thereof)
+    if (pin)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(worker % sysconf(_SC_NPROCESSORS_ONLN), &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+#endif
+
+    // watch worker's socket in worker's own event loop
+    if (!prepare())
+    {
+        stop();
+    }
+    return true;
+}
+
+/**
+ * Returns true iff header field named name (of n bytes, in any case) is connection-specific,
+ * and so forbidden in HTTP/2.
+ * https://tools.ietf.org/html/rfc7540#section-8.1.2.2
+ */
+bool specific(const char* name, size_t n)
+{
+    const char* names[] = {"Connection", "Keep-Alive", "Proxy-Connection", "Transfer-Encoding", "Upgrade"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (strlen(names[i]) == n && strncasecmp(names[i], name, n) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Finds end of a script's headers in its output, per CGI, whose lines might be
+ * terminated by LFs alone. Returns pointer to body that follows, else NULL.
+ */
+const BYTE* split(const BYTE* output, size_t length)
+{
+    for (size_t i = 0; i + 1 < length; i++)
+    {
+        if (output[i] == '\n' && output[i + 1] == '\n')
+        {
+            return output + i + 2;
+        }
+        if (output[i] == '\n' && output[i + 1] == '\r' && i + 2 < length && output[i + 2] == '\n')
+        {
+            return output + i + 3;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Starts server on its endpoints rooted at path, serving from n workers
+ * (optionally pinned to CPUs) or, if n is 0, from this process alone.
+ * Returns only in the process (or processes) that's to serve connections.
+ */
+void start(const char* path, int n, bool pin)
+{
+    // path to server's root
+    root = realpath(path, NULL);
+    if (root == NULL)
+    {
+        stop();
+    }
+
+    // ensure root is executable
+    if (access(root, X_OK) == -1)
+    {
+        stop();
+    }
+
+    // announce root
+    printf("\033[33m");
+    printf("Using %s for server's root", root);
+    printf("\033[39m\n");
+
+    // allow as many descriptors as may be, so that workers run out of connections
+    // (which they refuse gracefully) before running out of descriptors
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    // allocate table of clients' addresses, for each worker to count its clients in
+    npeers = (size_t) capacity * 2;
+    peers = calloc(npeers, sizeof(struct peer));
+    if (peers == NULL)
+    {
+        stop();
+    }
+
+    // render responses' Status-Lines and error pages, and date them, once for all workers
+    if (!render())
+    {
+        stop();
+    }
+    restamp();
+
+    // snapshot root, if immutable, once for all workers
+    if (immutable)
+    {
+        if (!freeze(root) || !bundle())
+        {
+            stop();
+        }
+        printf("\033[33m");
+        printf("Snapshotted %zu paths beneath server's root", snapshotted);
+        printf("\033[39m\n");
+    }
+
+    // launch FastCGI backend for PHP, unless one's been specified
+    if (fastcgi == NULL && !launch())
+    {
+        stop();
+    }
+
+    // map memory for each process's metrics, shared by workers so that any can report all
+    nmeters = (n == 0) ? 1 : n;
+    meters = mmap(NULL, nmeters * sizeof(struct metrics), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (meters == MAP_FAILED)
+    {
+        stop();
+    }
+    meter = &meters[0];
+
+    // serve from this process alone
+    if (n == 0)
+    {
+        for (int i = 0; i < nendpoints; i++)
+        {
+            endpoints[i].fd = inherit(endpoints[i].address, true);
+            if (endpoints[i].fd == -1)
+            {
+                endpoints[i].fd = listener(endpoints[i].address, false, true);
+            }
+            if (endpoints[i].fd == -1)
+            {
+                stop();
+            }
+            if (strncmp(endpoints[i].address, "unix:", strlen("unix:")) == 0 && ancestor == -1)
+            {
+                endpoints[i].path = endpoints[i].address + strlen("unix:");
+            }
+        }
+        if (!prepare())
+        {
+            stop();
+        }
+        succeed();
+        return;
+    }
+
+    // create one socket per worker per endpoint (unless handed down by predecessor),
+    // each endpoint's all bound to its port, across which kernel balances connections,
+    // except for a unix socket, which (since it can be bound but once) workers share,
+    // each accepting from it
+    pids = calloc(n, sizeof(pid_t));
+    sockets = malloc(n * nendpoints * sizeof(int));
+    if (pids == NULL || sockets == NULL)
+    {
+        stop();
+    }
+    for (workers = 0; workers < n; workers++)
+    {
+        for (int i = 0; i < nendpoints; i++)
+        {
+            bool local = (strncmp(endpoints[i].address, "unix:", strlen("unix:")) == 0);
+            int* fd = &sockets[workers * nendpoints + i];
+            *fd = (local && workers > 0) ? fcntl(sockets[i], F_DUPFD_CLOEXEC, 0) : inherit(endpoints[i].address, workers == 0);
+            if (*fd == -1 && !(local && workers > 0))
+            {
+                *fd = listener(endpoints[i].address, true, workers == 0);
+            }
+            if (*fd == -1)
+            {
+                stop();
+            }
+            if (local && workers == 0 && ancestor == -1)
+            {
+                endpoints[i].path = endpoints[i].address + strlen("unix:");
+            }
+        }
+    }
+
+    // announce workers
+    printf("\033[33m");
+    printf("Spawning %i workers", workers);
+    printf("\033[39m\n");
+
+    // spawn workers, returning in each
+    for (int i = 0; i < workers; i++)
+    {
+        if (spawn(i, pin))
+        {
+            return;
+        }
+    }
+    succeed();
+
+    // respawn workers as they die, returning in each
+    supervise(pin);
+}
+
+/**
+ * Stop server, deallocating any resources.
+ */
+void stop(void)
+{
+    // preserve errno across this function's library calls
+    int errsv = errno;
+
+    // announce stop
+    printf("\033[33m");
+    printf("Stopping server\n");
+    printf("\033[39m");
 
-	// Must begin with /
-	if (strncmp(request, "/", 1) != 0)
-	{
-		error(501);
-			return false;
-	}
-	// Must not have "
-	if (strchr(request, '"') != NULL)
-	{
-		error(400);
-		return false;
-	}
+    // free root, which was allocated by realpath
+    if (root != NULL)
+    {
+        free(root);
+    }
 
-	// Look for /r/n
-	const char* clrf = strstr(line, "\r\n");
-	if(clrf == NULL)
-	{
-		error(400);
-		return false;
-	}
+    // close server's sockets, removing any unix sockets bound by this process
+    for (int i = 0; i < nendpoints; i++)
+    {
+        if (endpoints[i].fd != -1)
+        {
+            close(endpoints[i].fd);
+        }
+        if (endpoints[i].path != NULL)
+        {
+            unlink(endpoints[i].path);
+        }
+    }
+    free(endpoints);
 
-	// Extract HTTP version
-	char version[clrf - secondSpace + 2 + 1];
-	strncpy(version, secondSpace + 1, clrf - secondSpace + 2);
-	version[sizeof(version) - 1] = '\0';
+    // close workers' sockets
+    if (sockets != NULL)
+    {
+        for (int i = 0; i < workers * nendpoints; i++)
+        {
+            close(sockets[i]);
+        }
+        free(sockets);
+    }
+    free(pids);
 
-	// Only HTTP/1.1 supported
-	if (strcmp(version, "HTTP/1.1\r\n") != 0)
-	{
-		error(505);
-		return false;
-	}
+    // close event loop
+    if (efd != -1)
+    {
+        close(efd);
+    }
 
-	//Extract abs_path and query
-	if(strchr(request, '?') != NULL)
-	{
-		char* queryBegins = strchr(line, '?');
+    // write whatever remains of access log
+    if (notes != NULL)
+    {
+        pthread_mutex_lock(&logging);
+        drain();
+        pthread_mutex_unlock(&logging);
+    }
 
-		strncpy(abs_path, firstSpace+1, queryBegins - firstSpace - 1);
-		abs_path[queryBegins - firstSpace - 1] = '\0';		
+    // stop php-cgi, if launched by server
+    if (php > 0)
+    {
+        kill(php, SIGTERM);
+        waitpid(php, NULL, 0);
+        unlink(fastcgi);
+        free(fastcgi);
+    }
 
-		strncpy(query, queryBegins+1, secondSpace - queryBegins);
-		query[secondSpace - queryBegins] = '\0';
-	}
-	else
-	{
-		query = NULL;
-		strcpy(abs_path, request);
-	}
+    // stop server
+    exit(errsv);
+}
 
-	return true;
+/**
+ * Streams backend's response to its client, beginning (in chunks) once script's
+ * headers are complete, and writing as much thereof as client will accept, unless
+ * client's still being dispatched (and so will be written to anyway).
+ * Returns false iff script's headers are invalid (or outgrow a buffer).
+ */
+bool stream(struct backend* b)
+{
+    // send script's headers (and whatever of its body has followed them)
+    struct connection* c = b->client;
+    if (!b->streaming)
+    {
+        if (split(b->output, b->produced) == NULL)
+        {
+            return b->produced <= BUFFER;
+        }
+        struct connection* saved = client;
+        client = c;
+        bool replied = reply(b->output, b->produced, true);
+        client = saved;
+        if (!replied)
+        {
+            return false;
+        }
+        free(b->output);
+        b->output = NULL;
+        b->produced = 0;
+        b->streaming = true;
+    }
+
+    // write response, reclaiming buffer once client has it all, else hang up if client has
+    if (c->state == WAITING)
+    {
+        if (flush(c))
+        {
+            c->size = 0;
+            c->sent = 0;
+        }
+        else if (c->state == CLOSING)
+        {
+            hangup(c);
+        }
+    }
+    return true;
 }
 
 /**
- * Returns status code's reason phrase.
- *
- * http://www.w3.org/Protocols/rfc2616/rfc2616-sec6.html#sec6
- * https://tools.ietf.org/html/rfc2324
+ * Submits job's current phase to io_uring, else (if job is just starting) to threads.
+ * Returns true iff submitted.
+ */
+bool submit(struct job* j)
+{
+#ifdef __linux__
+    if (ufd != -1)
+    {
+        // ensure there's room for job in submission queue and, once complete,
+        // in completion queue
+        unsigned int tail = *sqtail;
+        if (j->phase == DONE || flying >= ENTRIES || tail - __atomic_load_n(sqhead, __ATOMIC_ACQUIRE) > *sqmask)
+        {
+            return false;
+        }
+
+        // prepare submission queue's entry for job's phase
+        unsigned int index = tail & *sqmask;
+        struct io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(struct io_uring_sqe));
+        switch (j->phase)
+        {
+            case OPENING:
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = (uintptr_t) j->path;
+                sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                break;
+
+            case STATING:
+                sqe->opcode = IORING_OP_STATX;
+                sqe->fd = j->file;
+                sqe->addr = (uintptr_t) "";
+                sqe->len = STATX_BASIC_STATS;
+                sqe->off = (uintptr_t) &j->stx;
+                sqe->statx_flags = AT_EMPTY_PATH;
+                break;
+
+            case LOADING:
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = j->file;
+                sqe->addr = (uintptr_t) (j->body + j->length);
+                sqe->len = j->sb.st_size - j->length;
+                sqe->off = j->length;
+                break;
+
+            case DONE:
+                break;
+        }
+        sqe->user_data = (uintptr_t) j;
+
+        // submit entry
+        sqarray[index] = index;
+        __atomic_store_n(sqtail, tail + 1, __ATOMIC_RELEASE);
+        if (syscall(__NR_io_uring_enter, ufd, 1, 0, 0, NULL, 0) != 1)
+        {
+            __atomic_store_n(sqtail, tail, __ATOMIC_RELEASE);
+            return false;
+        }
+        flying++;
+        return true;
+    }
+#endif
+
+    // queue job for threads, oldest first
+    if (threads && j->phase == OPENING)
+    {
+        j->next = NULL;
+        pthread_mutex_lock(&lock);
+        if (pending == NULL)
+        {
+            pending = j;
+        }
+        else
+        {
+            latest->next = j;
+        }
+        latest = j;
+        pthread_cond_signal(&queued);
+        pthread_mutex_unlock(&lock);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Tells predecessor, if any, that server's listening on the sockets it handed down,
+ * whereupon predecessor quiesces, closing any no longer to be listened on, and takes
+ * over removal of unix sockets.
+ */
+void succeed(void)
+{
+    if (ancestor == -1)
+    {
+        return;
+    }
+    for (int i = 0; i < ninherited; i++)
+    {
+        if (inherited[i].fd != -1)
+        {
+            close(inherited[i].fd);
+        }
+        free((char*) inherited[i].address);
+    }
+    free(inherited);
+    inherited = NULL;
+    ninherited = 0;
+    for (int i = 0; i < nendpoints; i++)
+    {
+        if (strncmp(endpoints[i].address, "unix:", strlen("unix:")) == 0)
+        {
+            endpoints[i].path = endpoints[i].address + strlen("unix:");
+        }
+    }
+    ssize_t bytes;
+    while ((bytes = write(ancestor, "", 1)) == -1 && errno == EINTR)
+    {
+        continue;
+    }
+    close(ancestor);
+    ancestor = -1;
+}
+
+/**
+ * Waits for signals, respawning workers as they die, until control-c is heard,
+ * whereupon workers are stopped too, or until SIGQUIT is (or server's succeeded by
+ * an upgrade), whereupon workers quiesce, and server stops once they're done. Upon
+ * SIGHUP, spawns workers anew, with configuration reloaded, while old ones quiesce.
+ * Returns only in (re)spawned workers.
+ */
+void supervise(bool pin)
+{
+    // wait for signals synchronously, so that none can arrive unnoticed (e.g., while
+    // a worker's respawned), handling each between waits
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigaddset(&set, SIGHUP);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGQUIT);
+    sigaddset(&set, SIGUSR2);
+    sigprocmask(SIG_BLOCK, &set, NULL);
+    bool quiescing = false;
+    while (true)
+    {
+        // stop workers (and then server) upon control-c
+        if (signaled)
+        {
+            for (int i = 0; i < workers; i++)
+            {
+                if (pids[i] > 0)
+                {
+                    kill(pids[i], SIGINT);
+                }
+            }
+            if (php > 0)
+            {
+                kill(php, SIGTERM);
+            }
+            for (int i = 0; i < workers; i++)
+            {
+                if (pids[i] > 0)
+                {
+                    waitpid(pids[i], NULL, 0);
+                }
+            }
+            errno = 0;
+            stop();
+        }
+
+        // spawn workers anew upon SIGHUP, with configuration reloaded, each on its
+        // predecessor's sockets, whereon clients queue while predecessor quiesces
+        if (reloading && !quitting)
+        {
+            printf("\033[33m");
+            printf("Reloading server");
+            printf("\033[39m\n");
+            if (!reload())
+            {
+                printf("\033[33m");
+                printf("Can't reload server");
+                printf("\033[39m\n");
+            }
+            else
+            {
+                for (int i = 0; i < workers; i++)
+                {
+                    pid_t pid = pids[i];
+                    if (spawn(i, pin))
+                    {
+                        return;
+                    }
+                    if (pid > 0 && pids[i] != pid)
+                    {
+                        kill(pid, SIGQUIT);
+                    }
+                }
+            }
+        }
+
+        // hand sockets down to a successor upon SIGUSR2, then quiesce
+        if (upgrading && !quitting)
+        {
+            quitting = bequeath();
+        }
+        reloading = upgrading = false;
+
+        // have workers quiesce upon SIGQUIT (or once succeeded)
+        if (quitting && !quiescing)
+        {
+            for (int i = 0; i < workers; i++)
+            {
+                if (pids[i] > 0)
+                {
+                    kill(pids[i], SIGQUIT);
+                }
+            }
+            quiescing = true;
+        }
+
+        // respawn workers that have died (unless quitting), whose sockets have remained
+        // open all the while
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+        {
+            for (int i = 0; i < workers; i++)
+            {
+                if (pids[i] == pid)
+                {
+                    pids[i] = 0;
+                    if (quitting)
+                    {
+                        break;
+                    }
+                    printf("\033[33m");
+                    printf("Respawning worker %i (%s %i)", i,
+                        WIFSIGNALED(status) ? "signal" : "status",
+                        WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status));
+                    printf("\033[39m\n");
+
+                    // avoid spinning if worker keeps dying right away, recording none
+                    // of its connections as open
+                    sleep(1);
+                    __atomic_store_n(&meters[i].connections, 0, __ATOMIC_RELAXED);
+                    if (spawn(i, pin))
+                    {
+                        return;
+                    }
+                    break;
+                }
+            }
+        }
+
+        // stop once quiesced workers are done
+        bool done = quitting;
+        for (int i = 0; i < workers && done; i++)
+        {
+            done = (pids[i] <= 0);
+        }
+        if (done)
+        {
+            errno = 0;
+            stop();
+        }
+
+        // wait for a signal
+        int caught = sigwaitinfo(&set, NULL);
+        if (caught > 0)
+        {
+            handler(caught);
+        }
+    }
+}
+
+/**
+ * Formats in buffer (of size bytes) an entity-tag for file whose metadata is sb, as
+ * encoded in coding, per snprintf. Returns length thereof.
+ * https://tools.ietf.org/html/rfc7232#section-2.3
+ */
+int tag(char* buffer, size_t size, const struct stat* sb, enum coding coding)
+{
+    return snprintf(buffer, size, "\"%llx-%llx-%llx%s%s\"", (unsigned long long) sb->st_ino,
+        (unsigned long long) sb->st_size, (unsigned long long) sb->st_mtime,
+        (coding != IDENTITY) ? "-" : "", (coding != IDENTITY) ? codings[coding] : "");
+}
+
+/**
+ * Adds n (which may be negative) to one of this process's metrics, which only
+ * this process writes, so needn't lock, but whose value is visible to workers
+ * that read it.
+ */
+void tally(unsigned long long* counter, long long n)
+{
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+/**
+ * Thaws root's snapshot, if any, freeing its routes and entries and unmapping
+ * its bundle, whereupon root's no longer frozen.
+ */
+void thaw(void)
+{
+    // detach entries from routes that merely share them, before their owners free them
+    for (size_t i = 0; i < nsnapshot; i++)
+    {
+        for (struct route* r = snapshot[i]; r != NULL; r = r->chain)
+        {
+            if (r->entry != NULL && strcmp(r->entry->path, r->path) != 0)
+            {
+                r->entry = NULL;
+            }
+        }
+    }
+    for (size_t i = 0; i < nsnapshot; i++)
+    {
+        while (snapshot[i] != NULL)
+        {
+            struct route* r = snapshot[i];
+            snapshot[i] = r->chain;
+            if (r->entry != NULL)
+            {
+                free(r->entry->path);
+                free(r->entry);
+            }
+            free(r->path);
+            free(r->file);
+            free(r);
+        }
+    }
+    free(snapshot);
+    snapshot = NULL;
+    nsnapshot = 0;
+    snapshotted = 0;
+    if (bundled != NULL)
+    {
+        munmap(bundled, nbundled);
+        bundled = NULL;
+        nbundled = 0;
+    }
+    frozen = false;
+}
+
+/**
+ * Moves connection to slot of timer wheel wherein it's to be closed in seconds
+ * unless it progresses further, else (if seconds is 0) removes it from wheel.
+ */
+void timeout(struct connection* c, int seconds)
+{
+    // remove connection from its slot, if in one
+    if (c->deadline != 0)
+    {
+        if (c->earlier != NULL)
+        {
+            c->earlier->later = c->later;
+        }
+        else
+        {
+            wheel[(c->deadline / TICK) % SLOTS] = c->later;
+        }
+        if (c->later != NULL)
+        {
+            c->later->earlier = c->earlier;
+        }
+        c->earlier = c->later = NULL;
+        c->deadline = 0;
+        timed--;
+    }
+
+    // add connection to slot wherein its deadline falls, starting wheel's turns
+    // from now if it's been at rest
+    if (seconds > 0)
+    {
+        long t = now();
+        if (timed == 0)
+        {
+            ticked = t / TICK;
+        }
+        c->deadline = t + seconds * 1000;
+        struct connection** slot = &wheel[(c->deadline / TICK) % SLOTS];
+        c->later = *slot;
+        if (*slot != NULL)
+        {
+            (*slot)->earlier = c;
+        }
+        *slot = c;
+        timed++;
+    }
+}
+
+/**
+ * Transfers file at path with specified type to client, opening (and, if small enough
+ * to cache, loading) it via a job, asynchronously if possible, while client waits.
+ */
+void transfer(const char* path, const char* type)
+{
+    struct job* j = calloc(1, sizeof(struct job));
+    if (j == NULL || (j->path = strdup(path)) == NULL)
+    {
+        free(j);
+        error(500);
+        return;
+    }
+    j->client = client;
+    j->type = type;
+    j->phase = OPENING;
+    j->file = -1;
+    j->began = nanotime();
+    if (submit(j))
+    {
+        client->job = j;
+        return;
+    }
+
+    // else perform job here and now
+    perform(j);
+    resume(j);
+}
+
+/**
+ * Translates result of an SSL_read, SSL_write, or SSL_sendfile that failed on client's
+ * connection into read's and write's conventions, setting errno to EAGAIN if call's
+ * to be retried once socket's ready (e.g., to continue handshake). Returns 0 if client
+ * closed TLS connection, else -1.
  */
-const char* reason(unsigned short code)
+ssize_t translate(struct connection* c, int result)
 {
-    switch (code)
+    switch (SSL_get_error(c->ssl, result))
     {
-        case 200: return "OK";
-        case 301: return "Moved Permanently";
-        case 400: return "Bad Request";
-        case 403: return "Forbidden";
-        case 404: return "Not Found";
-        case 405: return "Method Not Allowed";
-        case 414: return "Request-URI Too Long";
-        case 418: return "I'm a teapot";
-        case 500: return "Internal Server Error";
-        case 501: return "Not Implemented";
-        case 505: return "HTTP Version Not Supported";
-        default: return NULL;
+        case SSL_ERROR_WANT_READ:
+        case SSL_ERROR_WANT_WRITE:
+            errno = EAGAIN;
+            return -1;
+
+        case SSL_ERROR_ZERO_RETURN:
+            return 0;
+
+        // after which TLS connection mustn't be shut down, but merely closed
+        case SSL_ERROR_SYSCALL:
+            errno = (errno == 0) ? ECONNRESET : errno;
+            SSL_set_quiet_shutdown(c->ssl, 1);
+            return -1;
+
+        default:
+            errno = EPROTO;
+            SSL_set_quiet_shutdown(c->ssl, 1);
+            return -1;
     }
 }
 
 /**
- * Redirects client to uri.
+ * Writes (without blocking) as many of HTTP/2 connection's queued frames as its socket
+ * will accept, discarding those written. Returns true iff all have been written.
  */
-void redirect(const char* uri)
+bool transmit(struct connection* c)
 {
-    char* template = "Location: %s\r\n";
-    char headers[strlen(template) - 2 + strlen(uri) + 1];
-    if (sprintf(headers, template, uri) < 0)
+    if (flush(c))
     {
-        error(500);
-        return;
+        c->size = 0;
+        c->sent = 0;
+        return true;
     }
-    respond(301, headers, NULL, 0);
+    if (c->sent > 0)
+    {
+        memmove(c->response, c->response + c->sent, c->size - c->sent);
+        c->size -= c->sent;
+        c->sent = 0;
+    }
+    return false;
 }
 
 /**
- * Reads (without blocking) an HTTP request's headers into memory dynamically allocated on heap.
- * Stores address thereof in *message and length thereof in *length.
+ * Determines whether n bytes of path, an absolute-path as URL-decoded, could reach
+ * beyond server's root (or be truncated), having a .. segment (or a NUL).
+ * https://tools.ietf.org/html/rfc3986#section-3.3
  */
-bool request(char** message, size_t* length)
+bool traverses(const char* path, size_t n)
 {
-    // ensure socket is open
-    if (cfd == -1)
+    if (find(path, n, '\0') != NULL)
     {
-        return false;
+        return true;
     }
+    for (const char* p = path; (p = find(p, n - (p - path), '/')) != NULL; p++)
+    {
+        size_t m = n - (p + 1 - path);
+        if (m >= 2 && p[1] == '.' && p[2] == '.' && (m == 2 || p[3] == '/'))
+        {
+            return true;
+        }
+    }
+    return false;
+}
 
-    // initialize message and its length
-    *message = NULL;
-    *length = 0;
-
-    // read message 
-    while (*length < LimitRequestLine + LimitRequestFields * LimitRequestFieldSize + 4)
+/**
+ * Decodes n bytes of an HPACK header block into message, as an HTTP/1.1 request
+ * (Request-Line, then Host, per :authority, then fields, with cookies recombined into
+ * one) of less than BUFFER bytes, storing its length in *length and, if urgency isn't
+ * NULL, its urgency (per Priority) in *urgency, all the while updating HTTP/2
+ * connection's table. Returns 0 if successful, 1 if request is malformed (or too
+ * large), or -1 if block can't be decoded, whereupon table can't be trusted.
+ * https://tools.ietf.org/html/rfc7541#section-6
+ * https://tools.ietf.org/html/rfc7540#section-8.1.2
+ */
+int unpack(struct session* s, const unsigned char* block, size_t n, char* message, size_t* length, int* urgency)
+{
+    // each field's name and value, back to back, pseudo-headers' values, and cookies
+    char field[BUFFER * 2];
+    char method[BYTES / 16] = "", path[LimitRequestLine] = "", authority[BYTES] = "";
+    bool scheme = false;
+    char cookies[BUFFER];
+    size_t baked = 0;
+
+    // decode fields, writing regular ones to message as they come
+    size_t written = 0;
+    bool regular = false, malformed = false;
+    for (const unsigned char* p = block, *end = block + n; p < end; )
     {
-        // read from socket
-        BYTE buffer[BYTES];
-        ssize_t bytes = read(cfd, buffer, BYTES);
-        if (bytes < 0)
+        size_t index, names, values;
+
+        // resize table
+        if ((*p & 0xe0) == 0x20)
         {
-            if (*message != NULL)
+            if (!integer(&p, end, 5, &index) || index > TABLE)
             {
-                free(*message);
-                *message = NULL;
+                return -1;
             }
-            *length = 0;
-            break;
+            s->limit = index;
+            shrink(s, index);
+            continue;
         }
 
-        // append bytes to message 
-        *message = realloc(*message, *length + bytes + 1);
-        if (*message == NULL)
+        // field in table
+        if ((*p & 0x80) != 0)
         {
-            *length = 0;
-            break;
+            if (!integer(&p, end, 7, &index) || !recall(s, index, field, &names, &values))
+            {
+                return -1;
+            }
         }
-        memcpy(*message + *length, buffer, bytes);
-        *length += bytes;
 
-        // null-terminate message thus far
-        *(*message + *length) = '\0';
-
-        // search for CRLF CRLF
-        int offset = (*length - bytes < 3) ? *length - bytes : 3;
-        char* haystack = *message + *length - bytes - offset;
-        char* needle = strstr(haystack, "\r\n\r\n");
-        if (needle != NULL)
+        // literal field, whose name may be in table, and which may be added thereto
+        else
         {
-            // trim to one CRLF and null-terminate
-            *length = needle - *message + 2;
-            *message = realloc(*message, *length + 1);
-            if (*message == NULL)
+            bool indexing = (*p & 0x40) != 0;
+            long m;
+            if (!integer(&p, end, indexing ? 6 : 4, &index))
             {
-                break;
+                return -1;
             }
-            *(*message + *length) = '\0';
-
-            // ensure request-line is no longer than LimitRequestLine
-            haystack = *message;
-            needle = strstr(haystack, "\r\n");
-            if (needle == NULL || (needle - haystack + 2) > LimitRequestLine)
+            if (index != 0 && !recall(s, index, field, &names, &values))
             {
-                break;
+                return -1;
             }
-
-            // count fields in message
-            int fields = 0;
-            haystack = needle + 2;
-            while (*haystack != '\0')
+            if (index == 0)
             {
-                // look for CRLF
-                needle = strstr(haystack, "\r\n");
-                if (needle == NULL)
+                if ((m = literal(&p, end, field, sizeof(field))) < 0)
                 {
-                    break;
+                    return -1;
                 }
+                names = m;
+            }
+            if ((m = literal(&p, end, field + names, sizeof(field) - names)) < 0)
+            {
+                return -1;
+            }
+            values = m;
+            if (indexing)
+            {
+                remember(s, field, names, values);
+            }
+        }
 
-                // ensure field is no longer than LimitRequestFieldSize
-                if (needle - haystack + 2 > LimitRequestFieldSize)
-                {
-                    break;
-                }
+        // once request is malformed, decode rest of block just to keep table in sync
+        const char* name = field;
+        const char* value = field + names;
+        for (size_t i = 0; i < values && !malformed; i++)
+        {
+            malformed = (value[i] == '\0' || value[i] == '\r' || value[i] == '\n');
+        }
+        if (malformed || names == 0)
+        {
+            malformed = true;
+            continue;
+        }
 
-                // look beyond CRLF
-                haystack = needle + 2;
+        // pseudo-headers, which precede regular fields, each at most once
+        if (name[0] == ':')
+        {
+            char* target = NULL;
+            size_t size = 0;
+            if (names == strlen(":method") && strncmp(name, ":method", names) == 0)
+            {
+                target = method;
+                size = sizeof(method);
             }
-
-            // if we didn't get to end of message, we must have erred
-            if (*haystack != '\0')
+            else if (names == strlen(":path") && strncmp(name, ":path", names) == 0)
             {
-                break;
+                target = path;
+                size = sizeof(path);
             }
-
-            // ensure message has no more than LimitRequestFields
-            if (fields > LimitRequestFields)
+            else if (names == strlen(":authority") && strncmp(name, ":authority", names) == 0)
             {
-                break;
+                target = authority;
+                size = sizeof(authority);
             }
+            else if (names == strlen(":scheme") && strncmp(name, ":scheme", names) == 0 && !scheme)
+            {
+                scheme = true;
+                malformed = regular;
+                continue;
+            }
+            if (target == NULL || target[0] != '\0' || regular || values == 0 || values >= size)
+            {
+                malformed = true;
+                continue;
+            }
+            memcpy(target, value, values);
+            target[values] = '\0';
+            continue;
+        }
 
-            // valid
-            return true;
+        // regular fields, whose names must be lowercase tokens, sans connection-specific ones
+        // (and TE, unless just "trailers")
+        regular = true;
+        for (size_t i = 0; i < names && !malformed; i++)
+        {
+            malformed = (name[i] <= ' ' || name[i] >= 0x7f || name[i] == ':' || (name[i] >= 'A' && name[i] <= 'Z'));
+        }
+        if (malformed || specific(name, names)
+            || (names == 2 && strncmp(name, "te", 2) == 0 && (values != 8 || strncmp(value, "trailers", 8) != 0)))
+        {
+            malformed = true;
+            continue;
+        }
+        if (urgency != NULL && names == strlen("priority") && strncmp(name, "priority", names) == 0)
+        {
+            *urgency = prioritize(value, values, *urgency);
         }
-    }
 
-    // invalid
-    if (*message != NULL)
-    {
-        free(*message);
-    }
-    *message = NULL;
-    *length = 0;
-    return false;
-}
+        // recombine cookies, which HTTP/2 lets clients split
+        // https://tools.ietf.org/html/rfc7540#section-8.1.2.5
+        if (names == strlen("cookie") && strncmp(name, "cookie", names) == 0)
+        {
+            if (baked + 2 + values > sizeof(cookies))
+            {
+                malformed = true;
+                continue;
+            }
+            if (baked > 0)
+            {
+                memcpy(cookies + baked, "; ", 2);
+                baked += 2;
+            }
+            memcpy(cookies + baked, value, values);
+            baked += values;
+            continue;
+        }
 
-/**
- * Responds to a client with status code, headers, and body of specified length.
- */
-void respond(int code, const char* headers, const char* body, size_t length)
-{
-    // determine Status-Line's phrase
-    // http://www.w3.org/Protocols/rfc2616/rfc2616-sec6.html#sec6.1
-    const char* phrase = reason(code);
-    if (phrase == NULL)
-    {
-        return;
+        // let :authority alone determine Host
+        if (authority[0] != '\0' && names == strlen("host") && strncmp(name, "host", names) == 0)
+        {
+            continue;
+        }
+        if (written + names + values + 4 >= BUFFER)
+        {
+            malformed = true;
+            continue;
+        }
+        memcpy(message + written, name, names);
+        memcpy(message + written + names, ": ", 2);
+        memcpy(message + written + names + 2, value, values);
+        memcpy(message + written + names + 2 + values, "\r\n", 2);
+        written += names + values + 4;
     }
-
-    // respond with Status-Line
-    if (dprintf(cfd, "HTTP/1.1 %i %s\r\n", code, phrase) < 0)
+    if (malformed || method[0] == '\0' || path[0] == '\0' || !scheme)
     {
-        return;
+        return 1;
     }
 
-    // respond with headers
-    if (dprintf(cfd, "%s", headers) < 0)
+    // prepend Request-Line and Host, then append Cookie and final CRLF
+    char head[sizeof(method) + sizeof(path) + sizeof(authority) + BYTES / 8];
+    int h = snprintf(head, sizeof(head), "%s %s HTTP/2.0\r\n", method, path);
+    if (authority[0] != '\0')
     {
-        return;
+        h += snprintf(head + h, sizeof(head) - h, "Host: %s\r\n", authority);
     }
-
-    // respond with CRLF
-    if (dprintf(cfd, "\r\n") < 0)
+    size_t total = h + written + ((baked > 0) ? strlen("Cookie: ") + baked + 2 : 0) + 2;
+    if (total >= BUFFER)
     {
-        return;
+        return 1;
     }
-
-    // respond with body
-    if (write(cfd, body, length) == -1)
+    memmove(message + h, message, written);
+    memcpy(message, head, h);
+    written += h;
+    if (baked > 0)
     {
-        return;
+        memcpy(message + written, "Cookie: ", strlen("Cookie: "));
+        written += strlen("Cookie: ");
+        memcpy(message + written, cookies, baked);
+        written += baked;
+        memcpy(message + written, "\r\n", 2);
+        written += 2;
     }
+    memcpy(message + written, "\r\n", 2);
+    *length = written + 2;
+    return 0;
+}
 
-    // log response line
-    if (code == 200)
+/**
+ * Forgets cached route for path and, if beneath, for every path beginning with it,
+ * else, if path is NULL, every route.
+ */
+void unroute(const char* path, bool beneath)
+{
+    if (routes == NULL)
     {
-        // green
-        printf("\033[32m");
+        return;
     }
-    else
+    size_t n = (path != NULL) ? strlen(path) : 0;
+    for (size_t i = 0; i < CacheRoutes && routed > 0; i++)
     {
-        // red
-        printf("\033[33m");
+        struct route** p = &routes[i];
+        while (*p != NULL)
+        {
+            struct route* r = *p;
+            if (path == NULL || (strncmp(r->path, path, n) == 0 && (beneath || r->path[n] == '\0')))
+            {
+                *p = r->chain;
+                r->cached = false;
+                forget(r);
+                routed--;
+            }
+            else
+            {
+                p = &r->chain;
+            }
+        }
     }
-    printf("HTTP/1.1 %i %s", code, phrase);
-    printf("\033[39m\n");
 }
 
 /**
- * Starts server on specified port rooted at path.
+ * Upgrades connection to HTTP/2, queuing server's connection preface (SETTINGS), after
+ * which client's is expected (or just its remainder, if client has sent "PRI * HTTP/2.0"
+ * already, as though a request). If client asked to upgrade (via Upgrade: h2c), 101 is
+ * queued first, client's HTTP2-Settings adopted, and request served as stream 1. Bytes
+ * pipelined after request are handled as frames. Returns true iff successful.
+ * https://tools.ietf.org/html/rfc7540#section-3.2
  */
-void start(short port, const char* path)
+bool upgrade(struct connection* c, bool asked)
 {
-    // path to server's root
-    root = realpath(path, NULL);
-    if (root == NULL)
-    {
-        stop();
-    }
-
-    // ensure root is executable
-    if (access(root, X_OK) == -1)
+    struct session* s = calloc(1, sizeof(struct session));
+    if (s == NULL)
     {
-        stop();
+        return false;
     }
-
-    // announce root
-    printf("\033[33m");
-    printf("Using %s for server's root", root);
-    printf("\033[39m\n");
-
-    // create a socket
-    sfd = socket(AF_INET, SOCK_STREAM, 0);
-    if (sfd == -1)
+    s->preface = asked ? "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n" : "SM\r\n\r\n";
+    s->window = WINDOW;
+    s->initial = WINDOW;
+    s->limit = TABLE;
+    c->session = s;
+
+    // switch protocols, adopting client's settings, as base64url (sans padding)
+    // https://tools.ietf.org/html/rfc7540#section-3.2.1
+    if (asked)
     {
-        stop();
+        const char* switching = "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n";
+        if (!grow(c, strlen(switching)))
+        {
+            return false;
+        }
+        memcpy(c->response + c->size, switching, strlen(switching));
+        c->size += strlen(switching);
+        const char* digits = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        size_t n, m = 0;
+        const char* value = header(c, "HTTP2-Settings", &n);
+        BYTE settings[BYTES];
+        unsigned int bits = 0;
+        int width = 0;
+        for (size_t i = 0; i < n && value[i] != '='; i++)
+        {
+            const char* digit = memchr(digits, value[i], 64);
+            if (digit == NULL || m == sizeof(settings))
+            {
+                return false;
+            }
+            bits = (bits << 6) | (digit - digits);
+            width += 6;
+            if (width >= 8)
+            {
+                width -= 8;
+                settings[m++] = bits >> width;
+            }
+        }
+        if (adopt(c, settings, m) != HTTP2_NO_ERROR)
+        {
+            return false;
+        }
     }
 
-    // allow reuse of address (to avoid "Address already in use")
-    int optval = 1;
-    setsockopt(sfd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
-
-    // assign name to socket
-    struct sockaddr_in serv_addr;
-    memset(&serv_addr, 0, sizeof(serv_addr));
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(port);
-    serv_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    if (bind(sfd, (struct sockaddr*) &serv_addr, sizeof(serv_addr)) == -1)
+    // send server's settings: how many streams client may open at once, and how
+    // large their headers may be
+    BYTE settings[12] = {0, HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 0, 0, Http2MaxConcurrentStreams >> 8,
+        Http2MaxConcurrentStreams & 0xff, 0, HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE, 0, 0, BUFFER >> 8, BUFFER & 0xff};
+    if (!post(c, HTTP2_SETTINGS, 0, 0, settings, sizeof(settings)))
     {
-        printf("\033[33m");
-        printf("Port %i already in use", port);
-        printf("\033[39m\n");
-        stop();
+        return false;
     }
 
-    // listen for connections
-    if (listen(sfd, SOMAXCONN) == -1)
-    {
-        stop();
-    }
+    // handle bytes pipelined after request as frames (or preface)
+    s->length = c->length - c->parsed.end;
+    memcpy(s->input, c->message + c->parsed.end, s->length);
 
-    // announce port in use
-    struct sockaddr_in addr;
-    socklen_t addrlen = sizeof(addr);
-    if (getsockname(sfd, (struct sockaddr*) &addr, &addrlen) == -1)
+    // serve request as stream 1 (once client's preface has arrived, lest its
+    // response precede connection's first frames)
+    if (asked)
     {
-        stop();
+        struct connection* t = branch(c, 1);
+        if (t == NULL)
+        {
+            return false;
+        }
+        s->highest = 1;
+        memcpy(t->message, c->message, c->parsed.end);
+        t->length = c->parsed.end;
     }
-    printf("\033[33m");
-    printf("Listening on port %i", ntohs(addr.sin_port));
-    printf("\033[39m\n");
+    c->length = 0;
+    memset(&c->parsed, 0, sizeof(c->parsed));
+    c->state = READING;
+    return true;
 }
 
 /**
- * Stop server, deallocating any resources.
+ * URL-decodes n bytes of s into t, which must have room for an undecoded copy of
+ * them (plus 1) but may be s itself, in a single pass that copies runs of bytes
+ * needing no decoding whole (or, in place, leaves them be). Returns decoded length.
  */
-void stop(void)
+size_t urldecode(const char* s, size_t n, char* t)
 {
-    // preserve errno across this function's library calls
-    int errsv = errno;
-
-    // announce stop
-    printf("\033[33m");
-    printf("Stopping server\n");
-    printf("\033[39m");
-
-    // free root, which was allocated by realpath
-    if (root != NULL)
+    size_t j = 0;
+    for (size_t i = 0; i < n; )
     {
-        free(root);
-    }
+        // decode percent-encoded octet, per https://www.ietf.org/rfc/rfc3986.txt,
+        // mapping each hex digit to its value branchlessly (e.g., 'a' and 'A'
+        // alike to 10)
+        if (s[i] == '%' && i + 2 < n && isxdigit((unsigned char) s[i + 1]) && isxdigit((unsigned char) s[i + 2]))
+        {
+            t[j++] = (((s[i + 1] & 0xF) + (s[i + 1] >> 6) * 9) << 4) | ((s[i + 2] & 0xF) + (s[i + 2] >> 6) * 9);
+            i += 3;
+        }
 
-    // close server socket
-    if (sfd != -1)
-    {
-        close(sfd);
+        // decode + as space
+        else if (s[i] == '+')
+        {
+            t[j++] = ' ';
+            i++;
+        }
+
+        // copy run of characters that needn't be decoded (including a lone %)
+        else
+        {
+            const char* encoded = scan(s + i + 1, n - i - 1, "%+");
+            size_t run = (encoded != NULL) ? encoded - (s + i) : n - i;
+            if (t + j != s + i)
+            {
+                memmove(t + j, s + i, run);
+            }
+            i += run;
+            j += run;
+        }
     }
+    t[j] = '\0';
 
-    // stop server
-    exit(errsv);
+    // decoded string's length
+    return j;
 }
 
 /**
- * Transfers file at path with specified type to client.
+ * Watches socket (edge-triggered) for readability and writability,
+ * associating data with it. Returns true iff successful.
  */
-void transfer(const char* path, const char* type)
+bool watch(int fd, void* data)
 {
-    // ensure path is readable
-    if (access(path, R_OK) == -1)
-    {
-        error(403);
-        return;
-    }
-
-    // open file
-    FILE* file = fopen(path, "r");
-    if (file == NULL)
-    {
-        error(500);
-        return;
-    }
+#ifdef __linux__
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = data;
+    return epoll_ctl(efd, EPOLL_CTL_ADD, fd, &event) == 0;
+#else
+    struct kevent events[2];
+    EV_SET(&events[0], fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, data);
+    EV_SET(&events[1], fd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, data);
+    return kevent(efd, events, 2, NULL, 0, NULL) == 0;
+#endif
+}
 
-    // load file's content
-    BYTE* content;
-    size_t length;
-    if (load(file, &content, &length) == false)
+/**
+ * Parses an HTTP-date (in any of its three formats), n bytes long.
+ * Returns it as seconds since epoch, else -1 if invalid.
+ * https://tools.ietf.org/html/rfc7231#section-7.1.1.1
+ */
+time_t when(const char* value, size_t n)
+{
+    if (n >= BYTES)
     {
-        error(500);
-        return;
+        return -1;
     }
-
-    // close file
-    fclose(file);
-
-    // prepare response
-    char* template = "Content-Type: %s\r\n";
-    char headers[strlen(template) - 2 + strlen(type) + 1];
-    if (sprintf(headers, template, type) < 0)
+    char date[BYTES];
+    memcpy(date, value, n);
+    date[n] = '\0';
+    const char* formats[] = {"%a, %d %b %Y %H:%M:%S GMT", "%A, %d-%b-%y %H:%M:%S GMT", "%a %b %e %H:%M:%S %Y"};
+    for (int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
     {
-        error(500);
-        return;
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        const char* end = strptime(date, formats[i], &tm);
+        if (end != NULL && *end == '\0')
+        {
+            return timegm(&tm);
+        }
     }
-
-    // respond with file's content
-    respond(200, headers, content, length);
-
-    // free file's content
-    free(content);
+    return -1;
 }
 
 /**
- * URL-decodes string, returning dynamically allocated memory for decoded string
- * that must be deallocated by caller.
+ * Performs jobs queued for threads until process exits, reporting each's
+ * completion to event loop.
  */
-char* urldecode(const char* s)
+void* work(void* arg)
 {
-    // check whether s is NULL
-    if (s == NULL)
-    {
-        return NULL;
-    }
-
-    // allocate enough (zeroed) memory for an undecoded copy of s
-    char* t = calloc(strlen(s) + 1, 1);
-    if (t == NULL)
-    {
-        return NULL;
-    }
-    
-    // iterate over characters in s, decoding percent-encoded octets, per
-    // https://www.ietf.org/rfc/rfc3986.txt
-    for (int i = 0, j = 0, n = strlen(s); i < n; i++, j++)
+    while (true)
     {
-        if (s[i] == '%' && i < n - 2)
-        {
-            char octet[3];
-            octet[0] = s[i + 1];
-            octet[1] = s[i + 2];
-            octet[2] = '\0';
-            t[j] = (char) strtol(octet, NULL, 16);
-            i += 2;
-        }
-        else if (s[i] == '+')
+        pthread_mutex_lock(&lock);
+        while (pending == NULL)
         {
-            t[j] = ' ';
+            pthread_cond_wait(&queued, &lock);
         }
-        else
+        struct job* j = pending;
+        pending = j->next;
+        pthread_mutex_unlock(&lock);
+
+        perform(j);
+
+        pthread_mutex_lock(&lock);
+        j->next = completed;
+        completed = j;
+        pthread_mutex_unlock(&lock);
+
+        // wake event loop (unless eventfd's counter or pipe is full, in which
+        // case event loop is yet to wake anyway)
+        uint64_t one = 1;
+        if (write(nfd[1], &one, sizeof(one)) == -1)
         {
-            t[j] = s[i];
+            continue;
         }
     }
-
-    // escaped string
-    return t;
+    return NULL;
 }